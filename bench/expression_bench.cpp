@@ -0,0 +1,129 @@
+// Compare evaluating production expressions by walking their trees with
+// running their compiled bytecode, over a set of model files.
+//
+// Usage: lsys-bench-expressions [-r repeats] model...
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+import LSys.LSysModel;
+import LSys.ModuleString;
+import LSys.ParsedModel;
+
+using LSYS::GetFinalProperties;
+using LSYS::GetParsedModel;
+using LSYS::LSysModel;
+using LSYS::ModuleString;
+using LSYS::Properties;
+
+namespace
+{
+
+constexpr auto DEFAULT_NUM_REPEATS = 5;
+constexpr auto RAND_SEED           = 1234U;
+
+struct RunResult
+{
+  double milliseconds;
+  size_t numModules;
+};
+
+// Derive maxGen generations, with the same random numbers on every run.
+[[nodiscard]] auto Derive(LSysModel& model, const int maxGen) -> RunResult
+{
+  model.SetSeed(RAND_SEED);
+
+  const auto start = std::chrono::steady_clock::now();
+  auto modules     = model.GetStartModuleString();
+  auto nextModules = std::make_unique<ModuleString>();
+  for (auto gen = 1; gen <= maxGen; ++gen)
+  {
+    model.Generate(*modules, *nextModules);
+    std::swap(modules, nextModules);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  return {std::chrono::duration<double, std::milli>(elapsed).count(), modules->size()};
+}
+
+[[nodiscard]] auto BestOf(LSysModel& model, const int maxGen, const int numRepeats) -> RunResult
+{
+  auto best = Derive(model, maxGen);
+  for (auto i = 1; i < numRepeats; ++i)
+  {
+    const auto result = Derive(model, maxGen);
+    best.milliseconds = std::min(best.milliseconds, result.milliseconds);
+  }
+  return best;
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+  try
+  {
+    auto numRepeats = DEFAULT_NUM_REPEATS;
+    auto filenames  = std::vector<std::string>{};
+    for (auto i = 1; i < argc; ++i)
+    {
+      if ((std::string{argv[i]} == "-r") and ((i + 1) < argc)) // NOLINT
+      {
+        numRepeats = std::max(1, std::atoi(argv[++i])); // NOLINT
+        continue;
+      }
+      filenames.emplace_back(argv[i]); // NOLINT
+    }
+    if (filenames.empty())
+    {
+      std::cerr << "Usage: " << argv[0] << " [-r repeats] model...\n"; // NOLINT
+      return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "model" << std::right << std::setw(12) << "modules"
+              << std::setw(12) << "tree ms" << std::setw(12) << "vm ms" << std::setw(10)
+              << "speedup" << "\n";
+
+    auto failed = false;
+    for (const auto& filename : filenames)
+    {
+      auto properties          = Properties{};
+      properties.inputFilename = filename;
+      const auto model         = GetParsedModel(properties);
+      const auto maxGen        = GetFinalProperties(model->GetSymbolTable(), properties).maxGen;
+
+      model->SetCompileExpressions(false);
+      const auto tree = BestOf(*model, maxGen, numRepeats);
+      model->SetCompileExpressions(true);
+      const auto vm = BestOf(*model, maxGen, numRepeats);
+
+      std::cout << std::left << std::setw(24) << filename << std::right << std::setw(12)
+                << vm.numModules << std::fixed << std::setprecision(2) << std::setw(12)
+                << tree.milliseconds << std::setw(12) << vm.milliseconds << std::setw(10)
+                << (tree.milliseconds / std::max(vm.milliseconds, 1.0E-6)) << "\n";
+
+      if (tree.numModules != vm.numModules)
+      {
+        std::cerr << filename << ": tree walk gave " << tree.numModules
+                  << " modules, bytecode gave " << vm.numModules << "\n";
+        failed = true;
+      }
+    }
+
+    return failed ? 1 : 0;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << "\n";
+    return 1;
+  }
+}
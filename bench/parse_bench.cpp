@@ -0,0 +1,182 @@
+// Measure parse throughput on a large machine-generated rule set, parsing
+// it both from an in-memory buffer and from a (memory-mapped) file, and
+// compare it with loading the same model compiled with --compile.
+//
+// Usage: lsys-bench-parse [-r repeats] [-n rules]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+import LSys.LSysModel;
+import LSys.ParsedModel;
+
+using LSYS::GetParsedModel;
+using LSYS::LSysModel;
+using LSYS::Properties;
+using LSYS::WriteCompiledModel;
+
+namespace
+{
+
+constexpr auto DEFAULT_NUM_REPEATS = 5;
+constexpr auto DEFAULT_NUM_RULES   = 20000;
+
+// A model with 'numRules' parametric productions, using contexts,
+//  conditions, nested expressions, branches and stochastic successors.
+[[nodiscard]] auto GetGeneratedModel(const int numRules) -> std::string
+{
+  auto text = std::ostringstream{};
+  text << "/* Generated model with " << numRules << " rules */\n";
+  text << "#define maxgen 1\n#define delta 22.5\n#define scale 0.75\n";
+  text << "START : A0(1, 2)\n";
+  for (auto i = 0; i < numRules; ++i)
+  {
+    const auto next = (i + 1) % numRules;
+    text << "p" << i << " : ";
+    if ((i % 4) == 1)
+    {
+      text << "B" << next << " < ";
+    }
+    text << "A" << i << "(x,y) : (x >= " << i % 10 << ") && (y < " << (i % 7) + 3.5 << ") ";
+    if ((i % 3) == 0)
+    {
+      text << "-> (0.5) F(x*scale) [+(delta) A" << next << "(x+1, y/2)] B" << next << "(x)\n";
+      text << "\t-> (0.5) F(x) [-(delta) A" << next << "(x-1, y^2)] @md(0.9) B" << next
+           << "(sin(x)+1.5e-3)\n";
+    }
+    else
+    {
+      text << "-> F(x*scale) [&(delta*" << i % 5 << ") ~L(x, y) A" << next
+           << "(x+1, y/2)] /(137.5) B" << next << "(x)\n";
+    }
+  }
+  return text.str();
+}
+
+// The best time of 'run'; 'release' is called, untimed, after each run.
+[[nodiscard]] auto BestOf(const int numRepeats,
+                          const std::function<void()>& run,
+                          const std::function<void()>& release) -> double
+{
+  auto best = 0.0;
+  for (auto i = 0; i < numRepeats; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const auto elapsed      = std::chrono::steady_clock::now() - start;
+    const auto milliseconds = std::chrono::duration<double, std::milli>(elapsed).count();
+    best                    = (i == 0) ? milliseconds : std::min(best, milliseconds);
+    release();
+  }
+  return best;
+}
+
+auto Report(const std::string_view name, const double milliseconds, const size_t numBytes,
+            const int numRules) -> void
+{
+  const auto seconds = std::max(milliseconds, 1.0E-6) / 1000.0;
+  std::cout << std::left << std::setw(12) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(12) << milliseconds << std::setw(12)
+            << ((static_cast<double>(numBytes) / (1024.0 * 1024.0)) / seconds) << std::setw(14)
+            << std::setprecision(0) << (static_cast<double>(numRules) / seconds) << "\n";
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+  try
+  {
+    auto numRepeats = DEFAULT_NUM_REPEATS;
+    auto numRules   = DEFAULT_NUM_RULES;
+    for (auto i = 1; i < argc; ++i)
+    {
+      const auto arg = std::string{argv[i]}; // NOLINT
+      if ((arg == "-r") and ((i + 1) < argc))
+      {
+        numRepeats = std::max(1, std::atoi(argv[++i])); // NOLINT
+      }
+      else if ((arg == "-n") and ((i + 1) < argc))
+      {
+        numRules = std::max(1, std::atoi(argv[++i])); // NOLINT
+      }
+      else
+      {
+        std::cerr << "Usage: " << argv[0] << " [-r repeats] [-n rules]\n"; // NOLINT
+        return 1;
+      }
+    }
+
+    const auto modelText = GetGeneratedModel(numRules);
+    const auto filename =
+        (std::filesystem::temp_directory_path() / "lsys-bench-parse.ls").string();
+    std::ofstream{filename, std::ios::binary} << modelText;
+
+    auto properties          = Properties{};
+    properties.inputFilename = filename;
+
+    // Freeing a model is not part of loading it.
+    auto model          = std::unique_ptr<LSysModel>{};
+    auto numParsedRules = size_t{0};
+    const auto release  = [&model, &numParsedRules]()
+    {
+      numParsedRules = model->GetRules().size();
+      model.reset();
+    };
+
+    std::cout << numRules << " rules, " << modelText.size() << " bytes\n";
+    std::cout << std::left << std::setw(12) << "source" << std::right << std::setw(12) << "ms"
+              << std::setw(12) << "MB/s" << std::setw(14) << "rules/s" << "\n";
+
+    const auto bufferMs =
+        BestOf(numRepeats, [&]() { model = GetParsedModel(modelText, properties); }, release);
+    Report("buffer", bufferMs, modelText.size(), numRules);
+    const auto bufferRules = numParsedRules;
+
+    const auto fileMs =
+        BestOf(numRepeats, [&]() { model = GetParsedModel(properties); }, release);
+    Report("file", fileMs, modelText.size(), numRules);
+    const auto fileRules = numParsedRules;
+
+    const auto compiledFilename =
+        (std::filesystem::temp_directory_path() / "lsys-bench-parse.lsc").string();
+    WriteCompiledModel(*GetParsedModel(properties), compiledFilename);
+    const auto compiledSize          = std::filesystem::file_size(compiledFilename);
+    auto compiledProperties          = properties;
+    compiledProperties.inputFilename = compiledFilename;
+
+    const auto compiledMs =
+        BestOf(numRepeats, [&]() { model = GetParsedModel(compiledProperties); }, release);
+    Report("compiled", compiledMs, static_cast<size_t>(compiledSize), numRules);
+
+    std::filesystem::remove(filename);
+    std::filesystem::remove(compiledFilename);
+
+    if ((bufferRules != static_cast<size_t>(numRules)) or (fileRules != bufferRules) or
+        (numParsedRules != bufferRules))
+    {
+      std::cerr << "Expected " << numRules << " rules, parsed " << bufferRules
+                << " from the buffer and " << fileRules << " from the file, and loaded "
+                << numParsedRules << " compiled.\n";
+      return 1;
+    }
+
+    return 0;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,182 @@
+// Measure interpreting the final generation of a set of models, with a
+// generator that discards its output, so the time is that of the actions
+// and the turtle math. Build with LSys_SCALAR_MATH on and off to compare
+// the SSE and scalar math; the bounds printed should not change. Models
+// with no module that turns the turtle out of the XY plane are interpreted
+// with the planar motion actions.
+//
+// Usage: lsys-bench-turtle [-r repeats] [-m maxgen] model...
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+import LSys.Consts;
+import LSys.Generator;
+import LSys.Interpret;
+import LSys.LSysModel;
+import LSys.ModuleString;
+import LSys.Name;
+import LSys.ParsedModel;
+import LSys.Polygon;
+import LSys.Vector;
+
+using LSYS::ArgsArray;
+using LSYS::BoundingBox;
+using LSYS::GetFinalProperties;
+using LSYS::GetParsedModel;
+using LSYS::IGenerator;
+using LSYS::Interpreter;
+using LSYS::LSysModel;
+using LSYS::ModuleString;
+using LSYS::Name;
+using LSYS::Properties;
+
+namespace
+{
+
+constexpr auto DEFAULT_NUM_REPEATS = 5;
+constexpr auto RAND_SEED           = 1234U;
+
+// Moves and draws still track the last position, as for a real generator.
+class NullGenerator : public IGenerator
+{
+public:
+  auto Postscript() -> void override {}
+  auto StartGraphics() -> void override {}
+  auto FlushGraphics() -> void override {}
+  auto DrawObject([[maybe_unused]] const Name& name,
+                  [[maybe_unused]] const int numArgs,
+                  [[maybe_unused]] const ArgsArray& args) -> void override
+  {
+  }
+  auto Polygon([[maybe_unused]] const LSYS::Polygon& polygon) -> void override {}
+  auto SetColor() -> void override {}
+  auto SetBackColor() -> void override {}
+  auto SetTexture() -> void override {}
+  auto SetWidth() -> void override {}
+
+  [[nodiscard]] auto GetBounds() const -> BoundingBox { return GetTurtle().GetBoundingBox(); }
+};
+
+struct RunResult
+{
+  double milliseconds;
+  bool planar; // Whether the planar motion actions were used
+  BoundingBox bounds;
+};
+
+[[nodiscard]] auto GetFinalGeneration(LSysModel& model, const int maxGen)
+    -> std::unique_ptr<ModuleString>
+{
+  model.SetSeed(RAND_SEED);
+
+  auto modules     = model.GetStartModuleString();
+  auto nextModules = std::make_unique<ModuleString>();
+  for (auto gen = 1; gen <= maxGen; ++gen)
+  {
+    model.Generate(*modules, *nextModules);
+    std::swap(modules, nextModules);
+  }
+
+  return modules;
+}
+
+[[nodiscard]] auto Interpret(const ModuleString& modules, const Properties& properties)
+    -> RunResult
+{
+  auto generator   = NullGenerator{};
+  auto interpreter = Interpreter{generator};
+  interpreter.SetDefaults({properties.turnAngle, properties.lineWidth, properties.lineDistance});
+
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.InterpretAllModules(modules);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  return {std::chrono::duration<double, std::milli>(elapsed).count(),
+          interpreter.IsPlanar(),
+          generator.GetBounds()};
+}
+
+[[nodiscard]] auto BestOf(const ModuleString& modules,
+                          const Properties& properties,
+                          const int numRepeats) -> RunResult
+{
+  auto best = Interpret(modules, properties);
+  for (auto i = 1; i < numRepeats; ++i)
+  {
+    best.milliseconds = std::min(best.milliseconds, Interpret(modules, properties).milliseconds);
+  }
+  return best;
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+  try
+  {
+    auto numRepeats = DEFAULT_NUM_REPEATS;
+    auto maxGen     = -1;
+    auto filenames  = std::vector<std::string>{};
+    for (auto i = 1; i < argc; ++i)
+    {
+      if ((std::string{argv[i]} == "-r") and ((i + 1) < argc)) // NOLINT
+      {
+        numRepeats = std::max(1, std::atoi(argv[++i])); // NOLINT
+        continue;
+      }
+      if ((std::string{argv[i]} == "-m") and ((i + 1) < argc)) // NOLINT
+      {
+        maxGen = std::atoi(argv[++i]); // NOLINT
+        continue;
+      }
+      filenames.emplace_back(argv[i]); // NOLINT
+    }
+    if (filenames.empty())
+    {
+      std::cerr << "Usage: " << argv[0] << " [-r repeats] [-m maxgen] model...\n"; // NOLINT
+      return 1;
+    }
+
+    std::cout << std::left << std::setw(24) << "model" << std::right << std::setw(12) << "modules"
+              << std::setw(12) << "ms" << std::setw(12) << "ns/module" << std::setw(8) << "planar"
+              << "  bounds\n";
+
+    for (const auto& filename : filenames)
+    {
+      auto properties          = Properties{};
+      properties.inputFilename = filename;
+      properties.maxGen        = maxGen;
+      const auto model         = GetParsedModel(properties);
+      const auto finalProps    = GetFinalProperties(model->GetSymbolTable(), properties);
+      const auto modules       = GetFinalGeneration(*model, finalProps.maxGen);
+
+      const auto result = BestOf(*modules, finalProps, numRepeats);
+
+      static constexpr auto NANOSECONDS_PER_MILLISECOND = 1.0E6;
+      const auto numModules = std::max(modules->size(), size_t{1});
+      std::cout << std::left << std::setw(24) << filename << std::right << std::setw(12)
+                << modules->size() << std::fixed << std::setprecision(2) << std::setw(12)
+                << result.milliseconds << std::setw(12)
+                << ((result.milliseconds * NANOSECONDS_PER_MILLISECOND) /
+                    static_cast<double>(numModules))
+                << std::setw(8) << (result.planar ? "yes" : "no") << "  " << result.bounds << "\n";
+    }
+
+    return 0;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << "Exception: " << e.what() << "\n";
+    return 1;
+  }
+}
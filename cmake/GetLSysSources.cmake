@@ -1,6 +1,7 @@
 function(LSys_get_modules LSys_root_dir module_files)
     set(LSys_modules
         ${LSys_root_dir}include/lsys/actions.cppm
+        ${LSys_root_dir}include/lsys/bytecode.cppm
         ${LSys_root_dir}include/lsys/consts.cppm
         ${LSys_root_dir}include/lsys/expression.cppm
         ${LSys_root_dir}include/lsys/generator.cppm
@@ -9,16 +10,20 @@ function(LSys_get_modules LSys_root_dir module_files)
         ${LSys_root_dir}include/lsys/interpret.cppm
         ${LSys_root_dir}include/lsys/l_sys_model.cppm
         ${LSys_root_dir}include/lsys/list.cppm
+        ${LSys_root_dir}include/lsys/model_stream.cppm
         ${LSys_root_dir}include/lsys/module.cppm
+        ${LSys_root_dir}include/lsys/module_string.cppm
         ${LSys_root_dir}include/lsys/name.cppm
         ${LSys_root_dir}include/lsys/parsed_model.cppm
         ${LSys_root_dir}include/lsys/polygon.cppm
         ${LSys_root_dir}include/lsys/production.cppm
         ${LSys_root_dir}include/lsys/radiance_generator.cppm
         ${LSys_root_dir}include/lsys/rand.cppm
+        ${LSys_root_dir}include/lsys/simd.cppm
         ${LSys_root_dir}include/lsys/symbol_table.cppm
         ${LSys_root_dir}include/lsys/turtle.cppm
         ${LSys_root_dir}include/lsys/value.cppm
+        ${LSys_root_dir}include/lsys/value_frame.cppm
         ${LSys_root_dir}include/lsys/vector.cppm
     )
 
@@ -28,8 +33,10 @@ endfunction()
 function(LSys_get_source_files LSys_root_dir source_files)
     set(LSys_source_files
         ${LSys_root_dir}include/lsys/debug.h
+        ${LSys_root_dir}include/lsys/lexer.h
         ${LSys_root_dir}include/lsys/parser.h
         ${LSys_root_dir}src/actions.cpp
+        ${LSys_root_dir}src/bytecode.cpp
         ${LSys_root_dir}src/consts.cpp
         ${LSys_root_dir}src/expression.cpp
         ${LSys_root_dir}src/generator.cpp
@@ -38,7 +45,9 @@ function(LSys_get_source_files LSys_root_dir source_files)
         ${LSys_root_dir}src/interpret.cpp
         ${LSys_root_dir}src/l_sys_model.cpp
         ${LSys_root_dir}src/lexer.cpp
+        ${LSys_root_dir}src/model_stream.cpp
         ${LSys_root_dir}src/module.cpp
+        ${LSys_root_dir}src/module_string.cpp
         ${LSys_root_dir}src/name.cpp
         ${LSys_root_dir}src/parsed_model.h
         ${LSys_root_dir}src/parsed_model.cpp
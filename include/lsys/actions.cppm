@@ -24,14 +24,16 @@
 
 module;
 
+#include <cstdint>
 #include <functional>
+#include <stack>
 
 export module LSys.Actions;
 
 import LSys.Consts;
 import LSys.Generator;
-import LSys.List;
-import LSys.Module;
+import LSys.ModuleString;
+import LSys.Polygon;
 import LSys.Turtle;
 
 export namespace LSYS
@@ -40,7 +42,30 @@ export namespace LSYS
 inline constexpr char DRAW_OBJECT_START_CHAR   = '~';
 inline constexpr const char* DRAW_OBJECT_START = "~";
 
-using ActionFunc = std::function<void(ConstListIterator<Module>& moduleIter,
+// Interpretation state carried from one action to the next: the polygons
+// being defined by '{ }' and the drawing attributes last sent to the
+// generator. Each Interpreter has its own, so interpreters can run
+// concurrently and each starts from the same state.
+struct ActionContext
+{
+  enum class State : uint8_t
+  {
+    START,
+    DRAWING,
+    POLYGON
+  };
+  State state = State::START;
+  std::stack<Polygon> polygonStack{};
+  float lastLineWidth = -1.0F;
+  Color lastColor{-1};
+  int lastTexture = -1;
+
+  friend auto operator==(const ActionContext& context1, const ActionContext& context2)
+      -> bool = default;
+};
+
+using ActionFunc = std::function<void(ActionContext& context,
+                                      ModuleStringIterator& moduleIter,
                                       Turtle& turtle,
                                       IGenerator& generator,
                                       int numArgs,
@@ -50,192 +75,272 @@ using ActionFunc = std::function<void(ConstListIterator<Module>& moduleIter,
 auto Prelude(Turtle& turtle) noexcept -> void;
 auto Postscript(Turtle& turtle) noexcept -> void;
 
-auto Move(ConstListIterator<Module>& moduleIter,
+// The InPlane motions use the turtle's planar turns and moves; the interpreter
+// chooses them for strings with no module that turns the turtle out of the plane.
+auto Move(ActionContext& context,
+          ModuleStringIterator& moduleIter,
           Turtle& turtle,
           IGenerator& generator,
           int numArgs,
           const ArgsArray& args) noexcept -> void;
-auto MoveHalf(ConstListIterator<Module>& moduleIter,
+auto MoveInPlane(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
+                 Turtle& turtle,
+                 IGenerator& generator,
+                 int numArgs,
+                 const ArgsArray& args) noexcept -> void;
+auto MoveHalf(ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               IGenerator& generator,
               int numArgs,
               const ArgsArray& args) noexcept -> void;
+auto MoveHalfInPlane(ActionContext& context,
+                     ModuleStringIterator& moduleIter,
+                     Turtle& turtle,
+                     IGenerator& generator,
+                     int numArgs,
+                     const ArgsArray& args) noexcept -> void;
 
-auto Draw(ConstListIterator<Module>& moduleIter,
+auto Draw(ActionContext& context,
+          ModuleStringIterator& moduleIter,
           Turtle& turtle,
           IGenerator& generator,
           int numArgs,
           const ArgsArray& args) noexcept -> void;
-auto DrawHalf(ConstListIterator<Module>& moduleIter,
+auto DrawInPlane(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
+                 Turtle& turtle,
+                 IGenerator& generator,
+                 int numArgs,
+                 const ArgsArray& args) noexcept -> void;
+auto DrawHalf(ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               IGenerator& generator,
               int numArgs,
               const ArgsArray& args) noexcept -> void;
+auto DrawHalfInPlane(ActionContext& context,
+                     ModuleStringIterator& moduleIter,
+                     Turtle& turtle,
+                     IGenerator& generator,
+                     int numArgs,
+                     const ArgsArray& args) noexcept -> void;
 
-auto DrawObject(ConstListIterator<Module>& moduleIter,
+auto DrawObject(const ActionContext& context,
+                ModuleStringIterator& moduleIter,
                 const Turtle& turtle,
                 IGenerator& generator,
                 int numArgs,
                 const ArgsArray& args) noexcept -> void;
 
-auto GeneralisedCylinderStart(ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderStart(const ActionContext& context,
+                              ModuleStringIterator& moduleIter,
                               Turtle& turtle,
                               IGenerator& generator,
                               int numArgs,
                               const ArgsArray& args) noexcept -> void;
-auto GeneralisedCylinderControlPoint(ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderControlPoint(const ActionContext& context,
+                                     ModuleStringIterator& moduleIter,
                                      Turtle& turtle,
                                      IGenerator& generator,
                                      int numArgs,
                                      const ArgsArray& args) noexcept -> void;
-auto GeneralisedCylinderEnd(ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderEnd(const ActionContext& context,
+                            ModuleStringIterator& moduleIter,
                             Turtle& turtle,
                             IGenerator& generator,
                             int numArgs,
                             const ArgsArray& args) noexcept -> void;
-auto GeneralisedCylinderTangents(ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderTangents(const ActionContext& context,
+                                 ModuleStringIterator& moduleIter,
                                  Turtle& turtle,
                                  IGenerator& generator,
                                  int numArgs,
                                  const ArgsArray& args) noexcept -> void;
-auto GeneralisedCylinderTangentLengths(ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderTangentLengths(const ActionContext& context,
+                                       ModuleStringIterator& moduleIter,
                                        Turtle& turtle,
                                        IGenerator& generator,
                                        int numArgs,
                                        const ArgsArray& args) noexcept -> void;
 
-auto TurnRight(ConstListIterator<Module>& moduleIter,
+auto TurnRight(const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                Turtle& turtle,
                const IGenerator& generator,
                int numArgs,
                const ArgsArray& args) noexcept -> void;
-auto TurnLeft(ConstListIterator<Module>& moduleIter,
+auto TurnRightInPlane(const ActionContext& context,
+                      ModuleStringIterator& moduleIter,
+                      Turtle& turtle,
+                      const IGenerator& generator,
+                      int numArgs,
+                      const ArgsArray& args) noexcept -> void;
+auto TurnLeft(const ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               const IGenerator& generator,
               int numArgs,
               const ArgsArray& args) noexcept -> void;
-auto PitchUp(ConstListIterator<Module>& moduleIter,
+auto TurnLeftInPlane(const ActionContext& context,
+                     ModuleStringIterator& moduleIter,
+                     Turtle& turtle,
+                     const IGenerator& generator,
+                     int numArgs,
+                     const ArgsArray& args) noexcept -> void;
+auto PitchUp(const ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              const IGenerator& generator,
              int numArgs,
              const ArgsArray& args) noexcept -> void;
-auto PitchDown(ConstListIterator<Module>& moduleIter,
+auto PitchDown(const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                Turtle& turtle,
                const IGenerator& generator,
                int numArgs,
                const ArgsArray& args) noexcept -> void;
-auto RollRight(ConstListIterator<Module>& moduleIter,
+auto RollRight(const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                Turtle& turtle,
                const IGenerator& generator,
                int numArgs,
                const ArgsArray& args) noexcept -> void;
-auto RollLeft(ConstListIterator<Module>& moduleIter,
+auto RollLeft(const ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               const IGenerator& generator,
               int numArgs,
               const ArgsArray& args) noexcept -> void;
-auto Reverse(ConstListIterator<Module>& moduleIter,
+auto Reverse(const ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              const IGenerator& generator,
              int numArgs,
              const ArgsArray& args) noexcept -> void;
-auto RollHorizontal(ConstListIterator<Module>& moduleIter,
+auto RollHorizontal(const ActionContext& context,
+                    ModuleStringIterator& moduleIter,
                     Turtle& turtle,
                     const IGenerator& generator,
                     int numArgs,
                     const ArgsArray& args) noexcept -> void;
 
-auto Push(ConstListIterator<Module>& moduleIter,
+auto Push(const ActionContext& context,
+          ModuleStringIterator& moduleIter,
           Turtle& turtle,
           const IGenerator& generator,
           int numArgs,
           const ArgsArray& args) noexcept -> void;
-auto Pop(ConstListIterator<Module>& moduleIter,
+auto Pop(ActionContext& context,
+         ModuleStringIterator& moduleIter,
          Turtle& turtle,
          IGenerator& generator,
          int numArgs,
          const ArgsArray& args) noexcept -> void;
-auto CutBranch(ConstListIterator<Module>& moduleIter,
+auto CutBranch(const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                const Turtle& turtle,
                const IGenerator& generator,
                int numArgs,
                const ArgsArray& args) noexcept -> void;
 
-auto MultiplyDefaultDistance(ConstListIterator<Module>& moduleIter,
+auto MultiplyDefaultDistance(const ActionContext& context,
+                             ModuleStringIterator& moduleIter,
                              Turtle& turtle,
                              const IGenerator& generator,
                              int numArgs,
                              const ArgsArray& args) noexcept -> void;
-auto MultiplyDefaultTurnAngle(ConstListIterator<Module>& moduleIter,
+auto MultiplyDefaultTurnAngle(const ActionContext& context,
+                              ModuleStringIterator& moduleIter,
                               Turtle& turtle,
                               const IGenerator& generator,
                               int numArgs,
                               const ArgsArray& args) noexcept -> void;
-auto MultiplyWidth(ConstListIterator<Module>& moduleIter,
+auto MultiplyWidth(ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    IGenerator& generator,
                    int numArgs,
                    const ArgsArray& args) noexcept -> void;
-auto ChangeWidth(ConstListIterator<Module>& moduleIter,
+auto ChangeWidth(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  IGenerator& generator,
                  int numArgs,
                  const ArgsArray& args) noexcept -> void;
 
-auto ChangeColor(ConstListIterator<Module>& moduleIter,
+auto ChangeColor(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  IGenerator& generator,
                  int numArgs,
                  const ArgsArray& args) noexcept -> void;
-auto ChangeTexture(ConstListIterator<Module>& moduleIter,
+auto ChangeTexture(ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    IGenerator& generator,
                    int numArgs,
                    const ArgsArray& args) noexcept -> void;
 
-auto StartPolygon(ConstListIterator<Module>& moduleIter,
+auto StartPolygon(ActionContext& context,
+                  ModuleStringIterator& moduleIter,
                   const Turtle& turtle,
                   IGenerator& generator,
                   int numArgs,
                   const ArgsArray& args) -> void;
-auto PolygonVertex(ConstListIterator<Module>& moduleIter,
+auto PolygonVertex(ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    const Turtle& turtle,
                    const IGenerator& generator,
                    int numArgs,
                    const ArgsArray& args) -> void;
-auto PolygonMove(ConstListIterator<Module>& moduleIter,
+auto PolygonMove(const ActionContext& context,
+                 ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  const IGenerator& generator,
                  int numArgs,
                  const ArgsArray& args) noexcept -> void;
-auto EndPolygon(ConstListIterator<Module>& moduleIter,
+auto PolygonMoveInPlane(const ActionContext& context,
+                        ModuleStringIterator& moduleIter,
+                        Turtle& turtle,
+                        const IGenerator& generator,
+                        int numArgs,
+                        const ArgsArray& args) noexcept -> void;
+auto EndPolygon(ActionContext& context,
+                ModuleStringIterator& moduleIter,
                 const Turtle& turtle,
                 IGenerator& generator,
                 int numArgs,
                 const ArgsArray& args) -> void;
 
-auto Tropism(ConstListIterator<Module>& moduleIter,
+auto Tropism(const ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              const IGenerator& generator,
              int numArgs,
              const ArgsArray& args) -> void;
 
-auto Flower(ConstListIterator<Module>& moduleIter,
+auto Flower(const ActionContext& context,
+            ModuleStringIterator& moduleIter,
             const Turtle& turtle,
             const IGenerator& generator,
             int numArgs,
             const ArgsArray& args) noexcept -> void;
-auto Leaf(ConstListIterator<Module>& moduleIter,
+auto Leaf(const ActionContext& context,
+          ModuleStringIterator& moduleIter,
           const Turtle& turtle,
           const IGenerator& generator,
           int numArgs,
           const ArgsArray& args) noexcept -> void;
-auto Internode(ConstListIterator<Module>& moduleIter,
+auto Internode(const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                const Turtle& turtle,
                const IGenerator& generator,
                int numArgs,
                const ArgsArray& args) noexcept -> void;
-auto FloweringApex(ConstListIterator<Module>& moduleIter,
+auto FloweringApex(const ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    const Turtle& turtle,
                    const IGenerator& generator,
                    int numArgs,
@@ -0,0 +1,91 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+export module LSys.Bytecode;
+
+import LSys.Name;
+import LSys.Value;
+import LSys.ValueFrame;
+
+export namespace LSYS
+{
+
+// A built-in function of expressions, applied to its evaluated arguments.
+using BuiltinFunc = auto (*)(std::span<const Value> args) -> Value;
+
+enum class OpCode : uint8_t
+{
+  PUSH_VALUE, // Push literal 'operand'
+  PUSH_FORMAL, // Push formal parameter slot 'operand'
+  PUSH_CONSTANT, // Push constant slot 'operand'
+  PUSH_NAME, // Push the symbol table value of name id 'operand'
+  CALL, // Replace the top 'numArgs' values by builtin 'operand' applied to them
+  UNKNOWN_FUNCTION, // Push an undefined value for a call of unknown name id 'operand'
+  NEGATE,
+  COMPLEMENT,
+  NOT,
+  BITWISE_AND,
+  BITWISE_OR,
+  AND,
+  OR,
+  EQ,
+  NE,
+  LT,
+  LE,
+  GE,
+  GT,
+  ADD,
+  SUBTRACT,
+  MULTIPLY,
+  DIVIDE,
+  MODULO,
+  POWER,
+};
+
+struct Instruction
+{
+  OpCode opCode;
+  uint8_t numArgs;
+  int operand;
+};
+
+// A sequence of expressions compiled to code for a stack machine, so they
+//  can be evaluated by one loop over a flat array instead of by walking
+//  expression trees. Running the code leaves the value of each expression,
+//  in order, on the stack.
+class Bytecode
+{
+public:
+  [[nodiscard]] auto empty() const noexcept -> bool { return m_code.empty(); }
+  [[nodiscard]] auto GetNumResults() const noexcept -> size_t { return m_numResults; }
+
+  // Code generation; the expression compiler emits operands before operators.
+  auto EmitValue(const Value& value) -> void;
+  auto EmitFormal(int slot) -> void;
+  auto EmitConstant(int slot) -> void;
+  auto EmitName(const Name& name) -> void;
+  auto EmitCall(BuiltinFunc func, size_t numArgs) -> void;
+  auto EmitUnknownFunction(const Name& name) -> void;
+  auto EmitOperator(OpCode opCode) -> void;
+  // Mark the end of an expression, whose value is then one of the results.
+  auto EndExpression() noexcept -> void { ++m_numResults; }
+
+  // Run the code, returning the results. They stay valid until the next Run
+  //  on this thread.
+  [[nodiscard]] auto Run(const ValueFrame& valueFrame) const -> std::span<const Value>;
+
+private:
+  std::vector<Instruction> m_code{};
+  std::vector<Value> m_values{};
+  std::vector<BuiltinFunc> m_functions{};
+  size_t m_numResults = 0;
+  size_t m_depth      = 0;
+  size_t m_maxDepth   = 0;
+  auto Emit(OpCode opCode, int operand, size_t numArgs, size_t numPopped) -> void;
+};
+
+} // namespace LSYS
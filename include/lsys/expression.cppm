@@ -36,13 +36,17 @@ module;
 #include <array>
 #include <memory>
 #include <ostream>
+#include <span>
 
 export module LSys.Expression;
 
+import LSys.Bytecode;
 import LSys.List;
+import LSys.ModelStream;
 import LSys.Name;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 export namespace LSYS
 {
@@ -67,10 +71,23 @@ public:
   [[nodiscard]] auto GetType() const -> int { return m_operation; }
   [[nodiscard]] auto GetName() const -> Name;
 
+  // Resolve the names in the expression to formal parameter or constant slots.
+  auto ResolveNames(const NameSlots& formalSlots,
+                    ConstantFrame& constants,
+                    const SymbolTable<Value>& symbolTable) -> void;
+  [[nodiscard]] auto GetFormalSlot() const -> int { return m_expressionValue.name.formalSlot; }
+
+  // Append code computing the expression, after its names are resolved.
+  auto Compile(Bytecode& code) const -> void;
+
+  // Write the expression to, or read one from, a compiled model.
+  auto Write(ModelWriter& writer) const -> void;
+  [[nodiscard]] static auto Read(ModelReader& reader) -> std::unique_ptr<Expression>;
+
   // Evaluation methods
-  [[nodiscard]] auto Evaluate(const SymbolTable<Value>& symbolTable) const -> Value;
-  [[nodiscard]] auto LEval(const SymbolTable<Value>& symbolTable) const -> Value;
-  [[nodiscard]] auto REval(const SymbolTable<Value>& symbolTable) const -> Value;
+  [[nodiscard]] auto Evaluate(const ValueFrame& valueFrame) const -> Value;
+  [[nodiscard]] auto LEval(const ValueFrame& valueFrame) const -> Value;
+  [[nodiscard]] auto REval(const ValueFrame& valueFrame) const -> Value;
 
   friend auto operator<<(std::ostream& out, const Expression& expression) -> std::ostream&;
 
@@ -83,6 +100,9 @@ private:
     {
       int id{};
       std::unique_ptr<List<Expression>> funcArgs;
+      BuiltinFunc func = nullptr; // Builtin of a function node, resolved when built
+      int formalSlot   = NO_SLOT;
+      int constantSlot = NO_SLOT;
     };
     Name name{};
     Value value; // Ensure union is big enough for a Value
@@ -103,19 +123,27 @@ private:
 auto operator<<(std::ostream& out, const Expression& expression) -> std::ostream&;
 
 [[nodiscard]] auto Bind(const List<Expression>* formals,
-                        const List<Expression>* values,
-                        SymbolTable<Value>& symbolTable) -> bool;
+                        std::span<const Value> values,
+                        ValueFrame& valueFrame) -> bool;
+// Give each formal of the list a slot.
+auto AddFormalSlots(const List<Expression>* formals, NameSlots& formalSlots) -> void;
+// Compile each expression of the list as one result of the code.
+auto Compile(const List<Expression>* expressionList, Bytecode& code) -> void;
+auto ResolveNames(List<Expression>* expressionList,
+                  const NameSlots& formalSlots,
+                  ConstantFrame& constants,
+                  const SymbolTable<Value>& symbolTable) -> void;
 [[nodiscard]] auto Conforms(const List<Expression>* formals, const List<Expression>* values)
     -> bool;
 //TODO(glk) Use unique_ptr.
 [[nodiscard]] auto Instantiate(const List<Expression>* before,
-                               const SymbolTable<Value>& symbolTable) noexcept
+                               const ValueFrame& valueFrame) noexcept
     -> std::unique_ptr<List<Expression>>;
-[[nodiscard]] auto GetFloat(const SymbolTable<Value>& symbolTable,
+[[nodiscard]] auto GetFloat(const ValueFrame& valueFrame,
                             const List<Expression>& expressionList,
                             float& fltValue,
                             unsigned int n = 0) -> bool;
-[[nodiscard]] auto GetValue(const SymbolTable<Value>& symbolTable,
+[[nodiscard]] auto GetValue(const ValueFrame& valueFrame,
                             const List<Expression>& expressionList,
                             Value& value,
                             unsigned int n = 0) -> bool;
@@ -126,14 +154,14 @@ namespace LSYS
 {
 
 // NOLINTNEXTLINE(misc-no-recursion)
-inline auto Expression::LEval(const SymbolTable<Value>& symbolTable) const -> Value
+inline auto Expression::LEval(const ValueFrame& valueFrame) const -> Value
 {
-  return GetLChild()->Evaluate(symbolTable);
+  return GetLChild()->Evaluate(valueFrame);
 }
 
-inline auto Expression::REval(const SymbolTable<Value>& symbolTable) const -> Value
+inline auto Expression::REval(const ValueFrame& valueFrame) const -> Value
 {
-  return GetRChild()->Evaluate(symbolTable);
+  return GetRChild()->Evaluate(valueFrame);
 }
 
 inline auto Expression::GetVarName() const -> Name
@@ -27,12 +27,15 @@
 
 module;
 
+#include <memory>
+#include <streambuf>
 #include <string>
+#include <string_view>
 
 export module LSys.Generator;
 
 import LSys.Consts;
-import LSys.Module;
+import LSys.Name;
 import LSys.Polygon;
 import LSys.Turtle;
 import LSys.Vector;
@@ -73,7 +76,7 @@ public:
   // Functions to draw objects in graphics mode
   virtual auto MoveTo() -> void;
   virtual auto LineTo() -> void;
-  virtual auto DrawObject(const Module& mod, int numArgs, const ArgsArray& args) -> void = 0;
+  virtual auto DrawObject(const Name& name, int numArgs, const ArgsArray& args) -> void = 0;
   virtual auto Polygon(const LSYS::Polygon& polygon) -> void                             = 0;
 
   // Functions to change rendering parameters
@@ -82,6 +85,20 @@ public:
   virtual auto SetTexture() -> void   = 0;
   virtual auto SetWidth() -> void     = 0;
 
+  // Functions for interpreting in parallel. A chunk generator carries on
+  // from this generator's drawing state, writing what it generates to
+  // 'output', or nowhere if that is null. The default, for generators that
+  // can't interpret in parallel, is to return null.
+  [[nodiscard]] virtual auto MakeChunkGenerator(std::streambuf* output) const
+      -> std::unique_ptr<IGenerator>;
+  // Append what a chunk generator wrote to this generator's output.
+  virtual auto AppendChunkOutput(std::string_view chunkOutput) -> void;
+  // The number of objects numbered in the output so far, which a chunk
+  // generator carries on from; a chunk interpreted without the chunks before
+  // it is told how many they number. The default is to number nothing.
+  [[nodiscard]] virtual auto GetNumObjects() const -> int;
+  virtual auto SetNumObjects(int numObjects) -> void;
+
 protected:
   [[nodiscard]] auto GetTurtle() const -> const Turtle&;
   [[noreturn]] virtual auto OutputFailed() -> void;
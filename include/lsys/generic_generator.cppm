@@ -1,13 +1,17 @@
 module;
 
 #include <fstream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
 #include <string>
+#include <string_view>
 
 export module LSys.GenericGenerator;
 
 import LSys.Consts;
 import LSys.Generator;
-import LSys.Module;
+import LSys.Name;
 import LSys.Polygon;
 import LSys.Turtle;
 import LSys.Vector;
@@ -36,7 +40,7 @@ public:
   auto Flower(float radius) -> void;
   auto Leaf(float length) -> void;
   auto Apex(Vector& start, float length) -> void;
-  auto DrawObject(const Module& mod, int numArgs, const ArgsArray& args) -> void override;
+  auto DrawObject(const Name& name, int numArgs, const ArgsArray& args) -> void override;
 
   // Functions to change rendering parameters
   auto SetColor() -> void override;
@@ -44,10 +48,18 @@ public:
   auto SetWidth() -> void override;
   auto SetTexture() -> void override;
 
+  [[nodiscard]] auto MakeChunkGenerator(std::streambuf* output) const
+      -> std::unique_ptr<IGenerator> override;
+  auto AppendChunkOutput(std::string_view chunkOutput) -> void override;
+  [[nodiscard]] auto GetNumObjects() const -> int override { return m_groupNum; }
+  auto SetNumObjects(const int numObjects) -> void override { m_groupNum = numObjects; }
+
 private:
-  std::ofstream m_output;
+  std::ofstream m_outputFile;
   std::ofstream m_boundsOutput;
+  std::ostream m_output; // Writes to the output file, or to a chunk generator's output
   int m_groupNum = 0;
+  GenericGenerator(const GenericGenerator& generator, std::streambuf* output);
   auto OutputBounds() -> void;
   auto OutputAttributes(const Turtle::State& turtleState) -> void;
 };
@@ -23,17 +23,21 @@
 
 module;
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 export module LSys.Interpret;
 
 import LSys.Actions;
 import LSys.Consts;
 import LSys.Generator;
-import LSys.List;
-import LSys.Module;
+import LSys.ModuleString;
+import LSys.Name;
 import LSys.SymbolTable;
 import LSys.Turtle;
 
@@ -55,27 +59,119 @@ public:
   auto SetDefaults(const DefaultParams& defaultParams) -> void;
 
   // Iteratively interpret a bound left-system, producing output to the specified generator.
-  auto Start(const List<Module>& moduleList) -> void;
+  auto Start(const ModuleString& modules) -> void;
   auto Finish() -> void;
 
   auto InterpretNext() -> void;
   [[nodiscard]] auto AllDone() const -> bool;
 
+  // True if the string is being interpreted with the planar motion actions,
+  // as the turtle starts in the XY plane and no module can turn it out of it.
+  [[nodiscard]] auto IsPlanar() const noexcept -> bool;
+
   // Interpret all of a bound left-system, producing output to the specified generator.
-  auto InterpretAllModules(const List<Module>& moduleList) -> void;
+  auto InterpretAllModules(const ModuleString& modules) -> void;
+
+  // Number of threads used by InterpretAllModules. With more than one
+  // thread, and a generator that can make chunk generators, a pass that only
+  // tracks the drawing state finds the state at the start of each chunk of
+  // the string; the chunks are then interpreted concurrently and their
+  // output appended in order.
+  [[nodiscard]] auto GetNumThreads() const noexcept -> uint32_t;
+  auto SetNumThreads(uint32_t numThreads) noexcept -> void;
+
+  // If set, the state at the start of each chunk is instead composed from the
+  // turtle's motion in the chunks before it, worked out concurrently, when the
+  // string's actions need nothing but that motion carried over. Composed
+  // coordinates round differently, so the output is no longer byte for byte
+  // that of one thread. Off by default.
+  [[nodiscard]] auto GetComposeChunks() const noexcept -> bool;
+  auto SetComposeChunks(bool composeChunks) noexcept -> void;
+
+  // Interpret a bound left-system given as a stream of consecutive pieces,
+  // as produced by LSysModel::DeriveStream.
+  auto StartStream() -> void;
+  auto InterpretStream(const ModuleString& modules) -> void;
+  auto FinishStream() -> void;
 
 private:
   Turtle m_turtle;
-  std::unique_ptr<ConstListIterator<Module>> m_moduleIter;
+  ActionContext m_actionContext{};
+  std::unique_ptr<ModuleStringIterator> m_moduleIter;
   IGenerator* m_generator;
 
-  const Module* m_currentModule{};
-
-  auto InterpretNextModule(const Module& mod) -> bool;
+  // A trailing ] is held back until the next piece arrives, so that Pop can
+  // look ahead as it does in a whole string.
+  ModuleString m_streamModules{};
+  ModuleString m_heldBackModule{};
+  int m_pendingCut = ModuleStringIterator::NO_CUT;
+  auto InterpretStreamModules() -> void;
+
+  // Action of each name id, looked up in the action table the first time
+  // the id is seen; an empty function if the name has no action.
+  std::vector<ActionFunc> m_actionsByNameId{};
+  [[nodiscard]] auto GetAction(int nameId) -> const ActionFunc&;
+  auto ResolveActions() -> void;
+  // Whether the actions come from the planar action table.
+  bool m_planar = false;
+  auto SetPlanar(bool planar) -> void;
+
+  uint32_t m_numThreads = 1U;
+  bool m_composeChunks  = false;
+  // Everything the interpretation of a chunk carries on from.
+  struct Chunk
+  {
+    size_t begin;
+    size_t end;
+    Turtle turtle;
+    ActionContext actionContext;
+    std::unique_ptr<IGenerator> generator; // Chunk generator with no output
+    std::string output;
+  };
+  [[nodiscard]] auto InterpretAllModulesInParallel(const ModuleString& modules) -> bool;
+  [[nodiscard]] auto GetChunks(const ModuleString& modules, IGenerator& stateGenerator)
+      -> std::vector<Chunk>;
+  auto InterpretChunk(const ModuleString& modules, Chunk& chunk) -> void;
+
+  // The turtle's motion in a chunk, moved from identity poses: the current
+  // pose and those on the stack at the start of the chunk. Each pose records
+  // which of those start poses, numbered from the bottom of the stack up,
+  // it is relative to.
+  struct ChunkMotion
+  {
+    size_t begin;
+    size_t end;
+    size_t startDepth; // Stack depth at the start of the chunk
+    ActionContext startContext;
+    Turtle turtle{};
+    size_t base = 0; // Start pose the current pose is relative to
+    std::vector<size_t> bases{}; // Start pose each pose on the stack is relative to
+    size_t minDepth = 0; // The stack below this depth still holds the start poses
+    ActionContext endContext{};
+    int numObjects = 0; // Objects numbered in the chunk's output
+  };
+  [[nodiscard]] auto GetComposedChunks(const ModuleString& modules,
+                                       const IGenerator& stateGenerator) -> std::vector<Chunk>;
+  [[nodiscard]] auto GetChunkMotions(const ModuleString& modules) const
+      -> std::vector<ChunkMotion>;
+  auto MoveChunk(const ModuleString& modules,
+                 const IGenerator& stateGenerator,
+                 ChunkMotion& motion) -> void;
+  [[nodiscard]] static auto ComposesMotions(const ModuleString& modules) -> bool;
+
+  auto InterpretNextModule() -> bool;
+  auto InterpretModule(ActionContext& actionContext,
+                       ModuleStringIterator& moduleIter,
+                       Turtle& turtle,
+                       IGenerator& generator) -> bool;
   static const SymbolTable<ActionFunc> ACTION_SYMBOL_TABLE;
+  static const SymbolTable<ActionFunc> PLANAR_ACTION_SYMBOL_TABLE;
   [[nodiscard]] static auto GetActionSymbolTable() -> SymbolTable<ActionFunc>;
-  [[nodiscard]] static auto GetModuleName(const Module& mod) -> std::string;
-  [[nodiscard]] static auto GetActionArgsArray(const Module& mod) -> std::pair<int, ArgsArray>;
+  [[nodiscard]] static auto GetPlanarActionSymbolTable() -> SymbolTable<ActionFunc>;
+  [[nodiscard]] static auto LeavesPlane(const ModuleString& modules) -> bool;
+  [[nodiscard]] static auto GetModuleName(const Name& name) -> std::string_view;
+  [[nodiscard]] static auto GetActionArgsArray(const ModuleString& modules, size_t i)
+      -> std::pair<int, ArgsArray>;
 };
 
 } // namespace LSYS
@@ -83,29 +179,73 @@ private:
 namespace LSYS
 {
 
-inline auto Interpreter::Start(const List<Module>& moduleList) -> void
+inline auto Interpreter::Start(const ModuleString& modules) -> void
 {
+  m_turtle.ReserveStack(modules.GetMaxBracketDepth());
+  SetPlanar(m_turtle.IsPlanar() and not LeavesPlane(modules));
   m_generator->Prelude();
-  m_moduleIter    = std::make_unique<ConstListIterator<Module>>(moduleList);
-  m_currentModule = m_moduleIter->first();
+  m_actionContext = ActionContext{};
+  m_moduleIter    = std::make_unique<ModuleStringIterator>(modules);
 }
 
 inline auto Interpreter::Finish() -> void
 {
-  m_currentModule = nullptr;
-  m_moduleIter    = nullptr;
+  m_moduleIter = nullptr;
   m_generator->Postscript();
 }
 
+inline auto Interpreter::GetAction(const int nameId) -> const ActionFunc&
+{
+  if (static_cast<size_t>(nameId) >= m_actionsByNameId.size())
+  {
+    ResolveActions();
+  }
+  return m_actionsByNameId[static_cast<size_t>(nameId)];
+}
+
+inline auto Interpreter::IsPlanar() const noexcept -> bool
+{
+  return m_planar;
+}
+
+inline auto Interpreter::SetPlanar(const bool planar) -> void
+{
+  if (planar != m_planar)
+  {
+    m_planar = planar;
+    m_actionsByNameId.clear();
+  }
+}
+
+inline auto Interpreter::GetNumThreads() const noexcept -> uint32_t
+{
+  return m_numThreads;
+}
+
+inline auto Interpreter::SetNumThreads(const uint32_t numThreads) noexcept -> void
+{
+  m_numThreads = (0 == numThreads) ? 1U : numThreads;
+}
+
+inline auto Interpreter::GetComposeChunks() const noexcept -> bool
+{
+  return m_composeChunks;
+}
+
+inline auto Interpreter::SetComposeChunks(const bool composeChunks) noexcept -> void
+{
+  m_composeChunks = composeChunks;
+}
+
 inline auto Interpreter::InterpretNext() -> void
 {
-  InterpretNextModule(*m_currentModule);
-  m_currentModule = m_moduleIter->next();
+  InterpretNextModule();
+  m_moduleIter->next();
 }
 
 inline auto Interpreter::AllDone() const -> bool
 {
-  return m_currentModule == nullptr;
+  return (m_moduleIter == nullptr) or m_moduleIter->AtEnd();
 }
 
 } // namespace LSYS
@@ -24,16 +24,24 @@
 
 module;
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 export module LSys.LSysModel;
 
 import LSys.List;
+import LSys.ModelStream;
 import LSys.Module;
+import LSys.ModuleString;
 import LSys.Production;
+import LSys.Rand;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 export namespace LSYS
 {
@@ -49,23 +57,116 @@ public:
   auto operator=(const LSysModel&) -> LSysModel& = delete;
   auto operator=(LSysModel&&) -> LSysModel&      = delete;
 
-  [[nodiscard]] auto Generate(List<Module>* oldModuleList) -> std::unique_ptr<List<Module>>;
+  // Apply the model to a module string for one generation, replacing the
+  // contents of newModules. newModules keeps its storage, so ping-ponging two
+  // strings between generations reuses their buffers instead of reallocating.
+  auto Generate(const ModuleString& oldModules, ModuleString& newModules) -> void;
+
+  // Streaming derivation for context-free models: expand the start string
+  // depth-first down to maxGen generations, passing the final modules to the
+  // consumer in order, in chunks, without materializing any generation.
+  // Memory is O(maxGen * successor length) rather than the size of the string.
+  using StreamConsumer = std::function<void(const ModuleString& modules)>;
+  [[nodiscard]] auto IsContextFree() const noexcept -> bool;
+  auto DeriveStream(const ModuleString& startModules, int maxGen, const StreamConsumer& consumer)
+      -> void;
+
+  // Module and parameter counts of each generation 0..maxGen, predicted from
+  // the productions alone, without generating. Counts saturate at the maximum
+  // uint64_t. Only deterministic context-free (D0L) models can be predicted;
+  // throws if a reachable module may be rewritten by any other production.
+  struct GenerationSize
+  {
+    uint64_t numModules;
+    uint64_t numValues;
+  };
+  [[nodiscard]] auto PredictGenerationSizes(int maxGen) -> std::vector<GenerationSize>;
+
+  // Whether production expressions are compiled to bytecode, rather than
+  // evaluated by walking their trees. Setting it re-indexes the rules.
+  [[nodiscard]] auto GetCompileExpressions() const noexcept -> bool;
+  auto SetCompileExpressions(bool compileExpressions) -> void;
+
+  // Number of threads used by Generate. With more than one thread, each
+  // generation is split into chunks rewritten concurrently, each chunk
+  // with its own binding scope and random number stream.
+  [[nodiscard]] auto GetNumThreads() const noexcept -> uint32_t;
+  auto SetNumThreads(uint32_t numThreads) noexcept -> void;
+
+  // The model's random number engine, which stochastic productions and rand()
+  // draw from while generating. Reseeding it restarts the random sequence, so
+  // a seed reproduces a derivation exactly, for a given number of threads.
+  [[nodiscard]] auto GetRandomEngine() noexcept -> RandomEngine&;
+  auto SetSeed(uint64_t seed) noexcept -> void;
 
   [[nodiscard]] auto GetSymbolTable() noexcept -> SymbolTable<Value>&;
   [[nodiscard]] auto GetIgnoreTable() noexcept -> SymbolTable<Value>&;
   [[nodiscard]] auto GetRules() noexcept -> List<Production>&;
 
-  auto ResetStartModuleList(List<Module>* moduleList) noexcept;
+  // Rebuild the index of rules by predecessor name. Must be called
+  // whenever the rule list changes.
+  auto IndexRules() -> void;
+
+  auto ResetStartModuleList(List<Module>* moduleList);
   [[nodiscard]] auto GetStartModuleList() const noexcept -> const List<Module>*;
+  // The starting module list as a module string, ready for Generate.
+  [[nodiscard]] auto GetStartModuleString() const -> std::unique_ptr<ModuleString>;
 
   auto ResetArgument(const std::string& name, const Value& newValue) -> void;
 
+  // A copy of an indexed model for generating with other arguments. The copy
+  // shares the rules and start list, which generating does not change, and
+  // has its own symbol table and constants, so resetting its arguments does
+  // not affect the original. The shared rules can no longer be re-indexed.
+  [[nodiscard]] auto Clone() const -> std::unique_ptr<LSysModel>;
+
+  // Write the model to, or read one from, a compiled model: its symbol and
+  // ignore tables, start list and rules. IndexRules must be called on a model
+  // that has been read.
+  auto Write(ModelWriter& writer) const -> void;
+  [[nodiscard]] static auto Read(ModelReader& reader) -> std::unique_ptr<LSysModel>;
+
 private:
-  SymbolTable<Value> m_symbolTable = SymbolTable<Value>{}; // Variables and bound formal parameters.
+  SymbolTable<Value> m_symbolTable = SymbolTable<Value>{}; // Global variables.
   SymbolTable<Value> m_ignoreTable = SymbolTable<Value>{}; // Symbols ignored in context.
-  List<Production> m_rules;
-
-  std::unique_ptr<List<Module>> m_start;
+  std::shared_ptr<List<Production>> m_rules = std::make_shared<List<Production>>();
+  uint32_t m_numThreads     = 1U;
+  bool m_compileExpressions = true;
+  RandomEngine m_randomEngine{};
+  // Candidate rules for each predecessor name id, in rule priority order.
+  std::vector<std::vector<const Production*>> m_rulesByName{};
+  // Context-sensitive rules need a bracket index on each generation, and so
+  // does a cut (%) in a successor, for the interpreter to skip its branch.
+  bool m_hasContextRules  = false;
+  bool m_hasCutSuccessors = false;
+  // Globals referred to by the rules, and the most formal slots any rule needs.
+  ConstantFrame m_constants{};
+  size_t m_numFormalSlots = 0;
+  [[nodiscard]] auto GetValueFrame() const -> ValueFrame;
+  [[nodiscard]] auto GetCandidateRules(int nameId) const noexcept
+      -> const std::vector<const Production*>*;
+  [[nodiscard]] auto FindMatchingRule(const ModuleString& modules,
+                                      size_t i,
+                                      ValueFrame& valueFrame) const -> const Production*;
+  struct StreamState
+  {
+    int maxGen;
+    const StreamConsumer* consumer;
+    ValueFrame valueFrame;
+    std::vector<ModuleString> successors; // Successor string being expanded at each generation
+    ModuleString output; // Final modules not yet passed to the consumer
+  };
+  auto DeriveDepthFirst(const ModuleString& modules, int gen, StreamState& state) -> void;
+  auto GenerateRange(const ModuleString& oldModules,
+                     size_t begin,
+                     size_t end,
+                     ValueFrame& valueFrame,
+                     ModuleString& newModules) const -> void;
+  // Per-chunk successor strings of the parallel generator, kept for reuse.
+  std::vector<ModuleString> m_chunkStrings{};
+  auto GenerateParallel(const ModuleString& oldModules, ModuleString& newModules) -> void;
+
+  std::shared_ptr<List<Module>> m_start;
 };
 
 } // namespace LSYS
@@ -85,10 +186,51 @@ inline auto LSysModel::GetIgnoreTable() noexcept -> SymbolTable<Value>&
 
 inline auto LSysModel::GetRules() noexcept -> List<Production>&
 {
-  return m_rules;
+  return *m_rules;
+}
+
+inline auto LSysModel::IsContextFree() const noexcept -> bool
+{
+  return not m_hasContextRules;
+}
+
+inline auto LSysModel::GetCompileExpressions() const noexcept -> bool
+{
+  return m_compileExpressions;
+}
+
+inline auto LSysModel::GetNumThreads() const noexcept -> uint32_t
+{
+  return m_numThreads;
+}
+
+inline auto LSysModel::SetNumThreads(const uint32_t numThreads) noexcept -> void
+{
+  m_numThreads = (0 == numThreads) ? 1U : numThreads;
+}
+
+inline auto LSysModel::GetRandomEngine() noexcept -> RandomEngine&
+{
+  return m_randomEngine;
+}
+
+inline auto LSysModel::SetSeed(const uint64_t seed) noexcept -> void
+{
+  m_randomEngine = RandomEngine{seed};
+}
+
+inline auto LSysModel::GetCandidateRules(const int nameId) const noexcept
+    -> const std::vector<const Production*>*
+{
+  const auto index = static_cast<size_t>(nameId);
+  if ((index >= m_rulesByName.size()) or m_rulesByName[index].empty())
+  {
+    return nullptr;
+  }
+  return &m_rulesByName[index];
 }
 
-inline auto LSysModel::ResetStartModuleList(List<Module>* const moduleList) noexcept
+inline auto LSysModel::ResetStartModuleList(List<Module>* const moduleList)
 {
   m_start.reset(moduleList);
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace LSYS
+{
+
+// Lexical analyzer for L-systems. All scanner state lives in the Lexer, so
+//  several models can be scanned at once, each by its own Lexer.
+// The rules, and the longest match choice between them, follow the original
+//  lex specification; the start states are those of lexdefs.h.
+class Lexer
+{
+public:
+  // The input must outlive the Lexer.
+  explicit Lexer(std::string_view input) noexcept;
+
+  // Scan the next token, returning 0 at the end of the input.
+  [[nodiscard]] auto NextToken() -> int;
+  // The text of the last name or number scanned (used by the parser).
+  [[nodiscard]] auto GetTokenText() const noexcept -> const std::string& { return m_tokenText; }
+
+  // Stack of start states adjusted by the parser.
+  auto PushState(int state) -> void;
+  auto PopState() -> void;
+
+  [[nodiscard]] auto GetLine() const noexcept -> int { return m_line; }
+  [[nodiscard]] auto GetColumn() const noexcept -> int { return m_column; }
+
+private:
+  static constexpr auto STACK_SIZE = 10;
+  std::string_view m_input;
+  size_t m_pos = 0;
+  int m_line   = 1;
+  int m_column = 1;
+  std::array<int, STACK_SIZE> m_states{}; // m_states[m_stateTop] is the current state
+  int m_stateTop = 0;
+  std::string m_tokenText{};
+
+  auto SwitchState(int state, const char* msg) const -> void;
+  auto SaveToken(std::string_view text) -> void;
+};
+
+} // namespace LSYS
@@ -0,0 +1,119 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+export module LSys.ModelStream;
+
+import LSys.List;
+import LSys.Name;
+import LSys.Value;
+
+export namespace LSYS
+{
+
+// The compiled model format: a parsed model written out as a flat stream of
+//  fixed size fields in native byte order, so it is loaded by reading the
+//  stream straight from a memory-mapped file, without lexing or parsing.
+// The stream starts with a header, then the table of the names the model
+//  uses. Names are written as indices into the table; loading interns each
+//  name once and maps the indices to the ids of this run, which is the only
+//  fix-up the model needs.
+inline constexpr auto MODEL_FORMAT_VERSION = 1U;
+
+class ModelWriter
+{
+public:
+  auto WriteInt(int32_t value) -> void;
+  auto WriteSize(size_t size) -> void;
+  auto WriteFloat(float value) -> void;
+  auto WriteBool(bool value) -> void;
+  auto WriteString(std::string_view str) -> void;
+  auto WriteName(const Name& name) -> void;
+  auto WriteValue(const Value& value) -> void;
+
+  // The complete stream: the header, the name table and the fields written.
+  [[nodiscard]] auto GetBytes() const -> std::string;
+
+private:
+  std::string m_fields{};
+  std::vector<int> m_nameIds{}; // Name ids in table order
+  std::vector<int> m_nameIndices{}; // Table index + 1 of each name id, 0 if not in the table
+  template<typename T>
+  auto WriteRaw(T value) -> void;
+};
+
+class ModelReader
+{
+public:
+  // Reads the header and the name table; throws if 'bytes' is not a stream
+  //  of this format version and byte order.
+  explicit ModelReader(std::string_view bytes);
+
+  [[nodiscard]] static auto IsModelStream(std::string_view bytes) noexcept -> bool;
+
+  [[nodiscard]] auto ReadInt() -> int32_t;
+  [[nodiscard]] auto ReadSize() -> size_t;
+  [[nodiscard]] auto ReadFloat() -> float;
+  [[nodiscard]] auto ReadBool() -> bool;
+  [[nodiscard]] auto ReadString() -> std::string_view;
+  [[nodiscard]] auto ReadName() -> Name;
+  [[nodiscard]] auto ReadValue() -> Value;
+
+  [[nodiscard]] auto AtEnd() const noexcept -> bool { return m_pos == m_bytes.size(); }
+
+private:
+  std::string_view m_bytes;
+  size_t m_pos = 0;
+  std::vector<int> m_nameIds{}; // Id in this run of each name table entry
+  template<typename T>
+  [[nodiscard]] auto ReadRaw() -> T;
+};
+
+// A list of objects with Write and Read members; the list may be null.
+template<typename T>
+auto WriteList(ModelWriter& writer, const List<T>* list) -> void;
+template<typename T>
+[[nodiscard]] auto ReadList(ModelReader& reader) -> std::unique_ptr<List<T>>;
+
+} // namespace LSYS
+
+namespace LSYS
+{
+
+template<typename T>
+auto WriteList(ModelWriter& writer, const List<T>* const list) -> void
+{
+  writer.WriteBool(list != nullptr);
+  if (list == nullptr)
+  {
+    return;
+  }
+  writer.WriteSize(list->size());
+  for (const auto& item : list->GetListAsArray())
+  {
+    item->Write(writer);
+  }
+}
+
+template<typename T>
+auto ReadList(ModelReader& reader) -> std::unique_ptr<List<T>>
+{
+  if (not reader.ReadBool())
+  {
+    return nullptr;
+  }
+  auto list           = std::make_unique<List<T>>();
+  const auto numItems = reader.ReadSize();
+  for (auto i = 0U; i < numItems; ++i)
+  {
+    list->append(T::Read(reader));
+  }
+  return list;
+}
+
+} // namespace LSYS
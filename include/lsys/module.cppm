@@ -30,15 +30,20 @@
 
 module;
 
+#include <cstddef>
 #include <memory>
 
 export module LSys.Module;
 
+import LSys.Bytecode;
 import LSys.Expression;
 import LSys.List;
+import LSys.ModelStream;
+import LSys.ModuleString;
 import LSys.Name;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 export namespace LSYS
 {
@@ -62,24 +67,44 @@ public:
   auto operator=(Module&&) -> Module&      = default;
 
   [[nodiscard]] auto GetName() const -> Name { return Name(m_tag); }
-
-  auto Bind(const Module& values, SymbolTable<Value>& symbolTable) const -> void;
-  [[nodiscard]] auto Conforms(const Module& mod) const -> bool;
+  [[nodiscard]] auto GetNumParams() const -> size_t
+  {
+    return (m_param == nullptr) ? 0U : m_param->size();
+  }
+
+  // Binding and conformance against module i of a module string.
+  auto Bind(const ModuleString& values, size_t i, ValueFrame& valueFrame) const -> void;
+  [[nodiscard]] auto Conforms(const ModuleString& modules, size_t i) const -> bool;
   [[nodiscard]] auto Ignore() const -> bool { return m_ignoreFlag; }
-  [[nodiscard]] auto Instantiate(const SymbolTable<Value>& symbolTable) const
-      -> std::unique_ptr<Module>;
+  // Append the module, with its expressions evaluated, to a module string.
+  auto Instantiate(const ValueFrame& valueFrame, ModuleString& moduleString) const -> void;
+  // Give the module's formal parameters slots, and resolve its expressions.
+  auto AddFormalSlots(NameSlots& formalSlots) const -> void;
+  auto ResolveNames(const NameSlots& formalSlots,
+                    ConstantFrame& constants,
+                    const SymbolTable<Value>& symbolTable) -> void;
+  // Compile the module's expressions, so Instantiate runs the code, or drop
+  // the code again so it walks the expression trees.
+  auto SetCompiled(bool compiled) -> void;
   [[nodiscard]] auto GetFloat(float& fltValue, unsigned int n = 0) const -> bool;
 
+  // Write the module to, or read one from, a compiled model.
+  auto Write(ModelWriter& writer) const -> void;
+  [[nodiscard]] static auto Read(ModelReader& reader) -> std::unique_ptr<Module>;
+
   friend auto operator<<(std::ostream& out, const Module& mod) -> std::ostream&;
 
 private:
   int m_tag; // Module name
   bool m_ignoreFlag; // Should module be ignored in context?
   std::unique_ptr<List<Expression>> m_param; // Expressions bound to module
+  std::unique_ptr<Bytecode> m_paramCode; // Compiled m_param, if any
 };
 
-[[nodiscard]] auto IsLeftBracket(const Name& name) noexcept -> bool;
-[[nodiscard]] auto IsRightBracket(const Name& name) noexcept -> bool;
+// Append all the modules of a list, instantiated, to a module string.
+auto Instantiate(const List<Module>& moduleList,
+                 const ValueFrame& valueFrame,
+                 ModuleString& moduleString) -> void;
 
 } // namespace LSYS
 
@@ -90,22 +115,10 @@ inline Module::Module(const Module& other) noexcept
   : m_tag{other.m_tag},
     m_ignoreFlag{other.m_ignoreFlag},
     m_param{other.m_param == nullptr ? std::make_unique<List<Expression>>()
-                                     : std::make_unique<List<Expression>>(*other.m_param)}
-{
-}
-
-inline auto IsLeftBracket(const Name& name) noexcept -> bool
+                                     : std::make_unique<List<Expression>>(*other.m_param)},
+    m_paramCode{other.m_paramCode == nullptr ? nullptr
+                                             : std::make_unique<Bytecode>(*other.m_paramCode)}
 {
-  static const auto s_LEFT_BRACKET = Name{"["};
-
-  return name == s_LEFT_BRACKET;
-}
-
-inline auto IsRightBracket(const Name& name) noexcept -> bool
-{
-  static const auto s_RIGHT_BRACKET = Name{"]"};
-
-  return name == s_RIGHT_BRACKET;
 }
 
 } // namespace LSYS
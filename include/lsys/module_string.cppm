@@ -0,0 +1,263 @@
+module;
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+export module LSys.ModuleString;
+
+import LSys.Name;
+import LSys.Value;
+
+export namespace LSYS
+{
+
+// A ModuleString is a flat, structure-of-arrays representation of a string
+//  of bound modules, as produced by each generation. Module name ids, ignore
+//  flags and parameter offsets are held in parallel arrays, and the parameters
+//  of all modules share a single value pool, so appending a module costs no
+//  allocations of its own. Module i has the parameters
+//  [m_paramOffsets[i], m_paramOffsets[i+1]) of the value pool.
+class ModuleString
+{
+public:
+  ModuleString() = default;
+
+  [[nodiscard]] auto size() const noexcept -> size_t { return m_nameIds.size(); }
+  [[nodiscard]] auto empty() const noexcept -> bool { return m_nameIds.empty(); }
+  [[nodiscard]] auto GetNumValues() const noexcept -> size_t { return m_values.size(); }
+  // Number of bytes used (or reserved) for the string.
+  [[nodiscard]] auto GetMemoryUsage() const noexcept -> size_t;
+  // Bytes needed per module and per parameter value, without a bracket index.
+  static constexpr auto BYTES_PER_MODULE = sizeof(int) + sizeof(uint8_t) + sizeof(uint32_t);
+  static constexpr auto BYTES_PER_VALUE  = sizeof(Value);
+
+  auto clear() noexcept -> void;
+  auto reserve(size_t numModules, size_t numValues) -> void;
+
+  [[nodiscard]] auto GetName(size_t i) const noexcept -> Name;
+  [[nodiscard]] auto GetNameId(size_t i) const noexcept -> int;
+  [[nodiscard]] auto Ignore(size_t i) const noexcept -> bool;
+  [[nodiscard]] auto GetNumParams(size_t i) const noexcept -> size_t;
+  [[nodiscard]] auto GetParams(size_t i) const noexcept -> std::span<const Value>;
+  // Return the nth (0 base) parameter of module i in fltValue, if available.
+  [[nodiscard]] auto GetFloat(size_t i, float& fltValue, size_t n = 0) const -> bool;
+
+  // Start a new module with no parameters; use AppendParam to add them.
+  auto AppendModule(const Name& name, bool ignoreFlag) -> void;
+  auto AppendParam(const Value& value) -> void;
+  // Append a copy of module i of another string.
+  auto Append(const ModuleString& other, size_t i) -> void;
+  auto Append(const ModuleString& other) -> void;
+
+  // Bracket structure. Ignored modules are never treated as brackets.
+  // Build the bracket index, making the bracket queries below O(1); without
+  // it they scan the string. Modifying the string invalidates the index.
+  static constexpr auto NO_BRACKET = static_cast<size_t>(-1);
+  auto IndexBrackets() -> void;
+  [[nodiscard]] auto HasBracketIndex() const noexcept -> bool;
+  [[nodiscard]] auto IsLeftBracket(size_t i) const noexcept -> bool;
+  [[nodiscard]] auto IsRightBracket(size_t i) const noexcept -> bool;
+  // Position of the bracket matching the bracket at i, or NO_BRACKET.
+  [[nodiscard]] auto GetMatchingBracket(size_t i) const noexcept -> size_t;
+  // Position of the ] closing the branch that module i belongs to, or
+  // NO_BRACKET. A [ belongs to the enclosing branch, a ] to the one it closes.
+  [[nodiscard]] auto GetBranchEnd(size_t i) const noexcept -> size_t;
+  // Deepest nesting of brackets in the string; unmatched ] are ignored.
+  [[nodiscard]] auto GetMaxBracketDepth() const noexcept -> size_t;
+
+  auto Print(std::ostream& out, size_t i) const -> void;
+  [[nodiscard]] auto ToString(size_t i) const -> std::string;
+  friend auto operator<<(std::ostream& out, const ModuleString& moduleString) -> std::ostream&;
+
+private:
+  std::vector<int> m_nameIds{};
+  std::vector<uint8_t> m_ignoreFlags{};
+  std::vector<uint32_t> m_paramOffsets{0};
+  std::vector<Value> m_values{};
+
+  // Bracket index: matching bracket of each bracket and the [ opening the
+  // branch each module belongs to, NO_BRACKET_INDEX if none.
+  static constexpr auto NO_BRACKET_INDEX = static_cast<uint32_t>(-1);
+  std::vector<uint32_t> m_matchingBracket{};
+  std::vector<uint32_t> m_parentBranch{};
+  [[nodiscard]] auto FindMatchingBracket(size_t i) const noexcept -> size_t;
+  [[nodiscard]] auto FindBranchEnd(size_t i) const noexcept -> size_t;
+};
+
+[[nodiscard]] auto IsLeftBracket(const Name& name) noexcept -> bool;
+[[nodiscard]] auto IsRightBracket(const Name& name) noexcept -> bool;
+
+// A position within a module string, moved back and forth by the interpreter
+//  and its actions. Moving off either end leaves the iterator at the end.
+class ModuleStringIterator
+{
+public:
+  explicit ModuleStringIterator(const ModuleString& moduleString) noexcept;
+
+  [[nodiscard]] auto GetModuleString() const noexcept -> const ModuleString&;
+  [[nodiscard]] auto GetPos() const noexcept -> size_t { return m_pos; }
+  auto SetPos(size_t pos) noexcept -> void;
+  [[nodiscard]] auto AtEnd() const noexcept -> bool { return m_pos >= m_moduleString->size(); }
+
+  // Move to the next or previous module; return false if there is none.
+  auto next() noexcept -> bool;
+  auto previous() noexcept -> bool;
+
+  // Name of the current module; the iterator must not be at the end.
+  [[nodiscard]] auto GetName() const noexcept -> Name;
+
+  // Skip to just before the ] closing the current branch, for the % action.
+  // If the string ends first, the iterator is left at the end with the cut
+  // pending; ResumeCut continues it on the next string of a stream.
+  static constexpr auto NO_CUT = -1;
+  auto CutBranch() noexcept -> void;
+  auto ResumeCut(int pendingCut) noexcept -> void;
+  [[nodiscard]] auto GetPendingCut() const noexcept -> int { return m_pendingCut; }
+
+private:
+  const ModuleString* m_moduleString;
+  size_t m_pos     = 0;
+  int m_pendingCut = NO_CUT; // Number of brackets still open in a pending cut.
+  auto SkipToBranchEnd(size_t pos, int openBrackets) noexcept -> void;
+};
+
+} // namespace LSYS
+
+namespace LSYS
+{
+
+inline auto ModuleString::GetName(const size_t i) const noexcept -> Name
+{
+  return Name{m_nameIds[i]};
+}
+
+inline auto ModuleString::GetNameId(const size_t i) const noexcept -> int
+{
+  return m_nameIds[i];
+}
+
+inline auto ModuleString::Ignore(const size_t i) const noexcept -> bool
+{
+  return m_ignoreFlags[i] != 0;
+}
+
+inline auto ModuleString::GetNumParams(const size_t i) const noexcept -> size_t
+{
+  return m_paramOffsets[i + 1] - m_paramOffsets[i];
+}
+
+inline auto ModuleString::GetParams(const size_t i) const noexcept -> std::span<const Value>
+{
+  return std::span<const Value>{m_values}.subspan(m_paramOffsets[i], GetNumParams(i));
+}
+
+inline auto ModuleString::HasBracketIndex() const noexcept -> bool
+{
+  return (not empty()) and (m_matchingBracket.size() == size());
+}
+
+inline auto ModuleString::IsLeftBracket(const size_t i) const noexcept -> bool
+{
+  return (not Ignore(i)) and LSYS::IsLeftBracket(GetName(i));
+}
+
+inline auto ModuleString::IsRightBracket(const size_t i) const noexcept -> bool
+{
+  return (not Ignore(i)) and LSYS::IsRightBracket(GetName(i));
+}
+
+inline auto ModuleString::GetMatchingBracket(const size_t i) const noexcept -> size_t
+{
+  if (not HasBracketIndex())
+  {
+    return FindMatchingBracket(i);
+  }
+  const auto match = m_matchingBracket[i];
+  return (match == NO_BRACKET_INDEX) ? NO_BRACKET : match;
+}
+
+inline auto ModuleString::GetBranchEnd(const size_t i) const noexcept -> size_t
+{
+  if (not HasBracketIndex())
+  {
+    return FindBranchEnd(i);
+  }
+  const auto parent = m_parentBranch[i];
+  if (parent == NO_BRACKET_INDEX)
+  {
+    return NO_BRACKET;
+  }
+  const auto end = m_matchingBracket[parent];
+  return (end == NO_BRACKET_INDEX) ? NO_BRACKET : end;
+}
+
+inline auto ModuleString::AppendParam(const Value& value) -> void
+{
+  assert(not empty());
+
+  m_values.push_back(value);
+  ++m_paramOffsets.back();
+}
+
+inline auto IsLeftBracket(const Name& name) noexcept -> bool
+{
+  static const auto s_LEFT_BRACKET = Name{"["};
+
+  return name == s_LEFT_BRACKET;
+}
+
+inline auto IsRightBracket(const Name& name) noexcept -> bool
+{
+  static const auto s_RIGHT_BRACKET = Name{"]"};
+
+  return name == s_RIGHT_BRACKET;
+}
+
+inline ModuleStringIterator::ModuleStringIterator(const ModuleString& moduleString) noexcept
+  : m_moduleString{&moduleString}
+{
+}
+
+inline auto ModuleStringIterator::GetModuleString() const noexcept -> const ModuleString&
+{
+  return *m_moduleString;
+}
+
+inline auto ModuleStringIterator::SetPos(const size_t pos) noexcept -> void
+{
+  m_pos = std::min(pos, m_moduleString->size());
+}
+
+inline auto ModuleStringIterator::next() noexcept -> bool
+{
+  if (AtEnd())
+  {
+    return false;
+  }
+  ++m_pos;
+  return not AtEnd();
+}
+
+inline auto ModuleStringIterator::previous() noexcept -> bool
+{
+  if ((0 == m_pos) or AtEnd())
+  {
+    m_pos = m_moduleString->size();
+    return false;
+  }
+  --m_pos;
+  return true;
+}
+
+inline auto ModuleStringIterator::GetName() const noexcept -> Name
+{
+  return m_moduleString->GetName(m_pos);
+}
+
+} // namespace LSYS
@@ -34,34 +34,52 @@
 
 module;
 
-#include <cstdint>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
 #include <ostream>
-#include <string>
+#include <string_view>
 
 export module LSys.Name;
 
-import LSys.SymbolTable;
-
 export namespace LSYS
 {
 
+// Names are interned: each distinct string gets a small integer id, and the
+//  string is kept, never moved, for the life of the program. Interning is
+//  thread-safe, and looking up the string of an id takes no lock.
 // NOLINTBEGIN(readability-identifier-naming, cppcoreguidelines-pro-bounds-pointer-arithmetic)
 class Name
 {
 public:
   explicit Name(const char* name);
+  explicit Name(std::string_view name);
   explicit Name(int id);
 
-  [[nodiscard]] auto str() const -> std::string { return s_reverseMap[m_index]; }
+  // The interned string; it is also null terminated.
+  [[nodiscard]] auto str() const noexcept -> std::string_view;
   [[nodiscard]] auto id() const -> int { return m_index; }
+  // Number of names interned so far; every id is less than this.
+  [[nodiscard]] static auto GetNumNames() noexcept -> int;
 
 private:
-  static inline SymbolTable<int> s_map{};
-  static char** s_reverseMap;
-  static int s_nextIndex;
-  static uint32_t s_reverseMapSize;
   int m_index = 0;
   friend auto operator==(const Name& a, const Name& b) -> bool;
+
+  // The strings of all ids, in segments that double in size, so the table
+  // grows without ever moving an entry that a reader may be looking at.
+  static constexpr auto FIRST_SEGMENT_SIZE = 64U;
+  static constexpr auto NUM_SEGMENTS       = 25U;
+  struct SegmentPos
+  {
+    size_t segment;
+    size_t offset;
+  };
+  [[nodiscard]] static auto GetSegmentPos(int id) noexcept -> SegmentPos;
+  static inline std::array<std::atomic<std::string_view*>, NUM_SEGMENTS> s_segments{};
+  static inline std::atomic<int> s_numNames{0};
+  [[nodiscard]] static auto Intern(std::string_view name) -> int;
 };
 // NOLINTEND(readability-identifier-naming, cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
@@ -73,9 +91,37 @@ auto operator<<(std::ostream& out, const Name& name) -> std::ostream&;
 namespace LSYS
 {
 
+inline Name::Name(const char* const name)
+  : Name{(nullptr == name) ? std::string_view{} : std::string_view{name}}
+{
+}
+
+inline Name::Name(const std::string_view name) : m_index{Intern(name)} {}
+
 inline Name::Name(const int id)
-  : m_index((id < 0) or (id >= static_cast<int>(s_reverseMapSize)) ? 0 : id)
+  : m_index((id < 0) or (id >= s_numNames.load(std::memory_order_acquire)) ? 0 : id)
+{
+}
+
+inline auto Name::GetNumNames() noexcept -> int
+{
+  return s_numNames.load(std::memory_order_acquire);
+}
+
+inline auto Name::GetSegmentPos(const int id) noexcept -> SegmentPos
+{
+  // Segment k holds FIRST_SEGMENT_SIZE * 2^k ids, starting at id
+  // FIRST_SEGMENT_SIZE * (2^k - 1).
+  const auto blocks  = (static_cast<size_t>(id) / FIRST_SEGMENT_SIZE) + 1;
+  const auto segment = static_cast<size_t>(std::bit_width(blocks)) - 1;
+  const auto start   = FIRST_SEGMENT_SIZE * ((size_t{1} << segment) - 1);
+  return {.segment = segment, .offset = static_cast<size_t>(id) - start};
+}
+
+inline auto Name::str() const noexcept -> std::string_view
 {
+  const auto pos = GetSegmentPos(m_index);
+  return s_segments[pos.segment].load(std::memory_order_acquire)[pos.offset];
 }
 
 inline auto operator==(const Name& a, const Name& b) -> bool
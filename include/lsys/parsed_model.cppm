@@ -1,11 +1,14 @@
 module;
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 
 export module LSys.ParsedModel;
 
 import LSys.LSysModel;
+import LSys.Rand;
 import LSys.SymbolTable;
 import LSys.Value;
 
@@ -19,11 +22,25 @@ struct Properties
   float turnAngle    = -1.0F;
   float lineWidth    = -1.0F;
   float lineDistance = -1.0F;
+  uint64_t seed      = RandomEngine::DEFAULT_SEED; // Seed of the model's random number engine
 };
 
 auto SetParserDebug(bool debugOn) noexcept -> void;
 
+// Parse the model in 'properties.inputFilename'.
 [[nodiscard]] auto GetParsedModel(const Properties& properties) -> std::unique_ptr<LSysModel>;
+// Parse a model from its text, which is scanned in place and need only
+//  outlive the call. 'properties.inputFilename' is not used.
+[[nodiscard]] auto GetParsedModel(std::string_view modelText, const Properties& properties)
+    -> std::unique_ptr<LSysModel>;
+// Load a model from a compiled model (see ModelStream), which is read in
+//  place and need only outlive the call. Any properties set replace the
+//  model's table entries, as they do when parsing.
+[[nodiscard]] auto GetCompiledModel(std::string_view modelBytes, const Properties& properties)
+    -> std::unique_ptr<LSysModel>;
+// Write 'model' to 'filename' as a compiled model, which GetParsedModel
+//  loads in place of the model text.
+auto WriteCompiledModel(const LSysModel& model, const std::string& filename) -> void;
 
 // Add default properties from the symbol table, provided they're
 // not overridden by existing properties.
@@ -31,6 +31,10 @@
 
 #pragma once
 
+#include "lexer.h"
+
+#include <string_view>
+
 import LSys.Expression;
 import LSys.List;
 import LSys.LSysModel;
@@ -38,16 +42,36 @@ import LSys.Module;
 import LSys.Name;
 import LSys.Production;
 import LSys.Value;
+import LSys.ValueFrame;
+
+namespace LSYS
+{
+
+// Everything one parse needs: the model being built and the scanner over its
+//  input. Each parse has its own context, so models can be parsed concurrently.
+struct ParseContext
+{
+  ParseContext(LSysModel& parsedModel, const std::string_view input) noexcept
+    : model{&parsedModel}, lexer{input}
+  {
+  }
+
+  LSysModel* model;
+  Lexer lexer;
+  // A separate list of CF productions is maintained until all
+  //  productions have been read.
+  List<Production> contextFreeRules{};
+  // Should expressions be evaluated when read in?
+  bool bindExpression = false;
+};
 
-#define parserRules (parseInfo->GetRules())
-#define parserSymbolTable (parseInfo->GetSymbolTable())
-#define parserIgnoreTable (parseInfo->GetIgnoreTable())
-#define parserStart (parseInfo->GetStartModuleList())
-#define parserStartReset(moduleList) (parseInfo->ResetStartModuleList(moduleList))
+} // namespace LSYS
 
-// In lex.l, for setting input stream
-void set_parser_input(const char* ifile);
+#define parserRules (context.model->GetRules())
+#define parserSymbolTable (context.model->GetSymbolTable())
+#define parserIgnoreTable (context.model->GetIgnoreTable())
+#define parserStart (context.model->GetStartModuleList())
+#define parserStartReset(moduleList) (context.model->ResetStartModuleList(moduleList))
 
-// In lsys.y, for setting parser state
-void set_parser_globals(LSYS::LSysModel*);
-int yyparse(void);
+// In lsys.y
+int yyparse(LSYS::ParseContext& context);
@@ -27,16 +27,22 @@
 
 module;
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 export module LSys.Production;
 
+import LSys.Bytecode;
 import LSys.Expression;
 import LSys.List;
+import LSys.ModelStream;
 import LSys.Module;
+import LSys.ModuleString;
 import LSys.Name;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 export namespace LSYS
 {
@@ -56,6 +62,9 @@ struct Predecessor
   {
   }
 
+  auto Write(ModelWriter& writer) const -> void;
+  [[nodiscard]] static auto Read(ModelReader& reader) -> std::unique_ptr<Predecessor>;
+
   friend auto operator<<(std::ostream& out, const Predecessor& predecessor) -> std::ostream&;
 
   std::unique_ptr<List<Module>> left;
@@ -72,17 +81,20 @@ struct Predecessor
 class Successor
 {
 public:
-  explicit Successor(std::unique_ptr<const List<Module>> moduleList, const float probability = 1.0F)
+  explicit Successor(std::unique_ptr<List<Module>> moduleList, const float probability = 1.0F)
     : m_probability{probability}, m_moduleList{std::move(moduleList)}
   {
   }
 
+  auto Write(ModelWriter& writer) const -> void;
+  [[nodiscard]] static auto Read(ModelReader& reader) -> std::unique_ptr<Successor>;
+
   friend class Production;
   friend auto operator<<(std::ostream& out, const Successor& successor) -> std::ostream&;
 
 private:
   float m_probability;
-  std::unique_ptr<const List<Module>> m_moduleList;
+  std::unique_ptr<List<Module>> m_moduleList;
 };
 
 // A Production is applied to a Module to produce a new list of Modules.
@@ -92,15 +104,37 @@ class Production
 public:
   Production(const Name& name,
              std::unique_ptr<Predecessor> input,
-             std::unique_ptr<const Expression> condition,
-             std::unique_ptr<const List<Successor>> successors);
+             std::unique_ptr<Expression> condition,
+             std::unique_ptr<List<Successor>> successors);
 
   [[nodiscard]] auto IsContextFree() const -> bool { return m_contextFree; }
-  auto Matches(const ListIterator<Module>& modIter,
-               const Module* mod,
-               SymbolTable<Value>& symbolTable) const -> bool;
-  auto Produce(const Module* predecessor, SymbolTable<Value>& symbolTable) const
-      -> std::unique_ptr<List<Module>>;
+  [[nodiscard]] auto GetPredecessorName() const -> Name { return m_input->center->GetName(); }
+  [[nodiscard]] auto GetPredecessorNumParams() const -> size_t
+  {
+    return m_input->center->GetNumParams();
+  }
+  // A deterministic production is context-free and unconditional, with a
+  // single successor, so it always rewrites a conforming module the same way.
+  [[nodiscard]] auto IsDeterministic() const -> bool;
+  // The successor of a deterministic production.
+  [[nodiscard]] auto GetDeterministicSuccessor() const -> const List<Module>&;
+  // Does any successor contain a module with this name?
+  [[nodiscard]] auto HasSuccessorModule(const Name& name) const -> bool;
+  // Give the formal parameters of the predecessor slots, and resolve the names
+  // of all the production's expressions. Returns the number of formal slots.
+  auto ResolveNames(ConstantFrame& constants, const SymbolTable<Value>& symbolTable) -> size_t;
+  // Compile (or drop the code of) the condition and successor expressions,
+  // once their names are resolved.
+  auto SetCompiled(bool compiled) -> void;
+  auto Matches(const ModuleString& modules, size_t pos, ValueFrame& valueFrame) const -> bool;
+  auto Produce(const ModuleString& modules,
+               size_t pos,
+               ValueFrame& valueFrame,
+               ModuleString& successor) const -> void;
+
+  // Write the production to, or read one from, a compiled model.
+  auto Write(ModelWriter& writer) const -> void;
+  [[nodiscard]] static auto Read(ModelReader& reader) -> std::unique_ptr<Production>;
 
   friend auto operator<<(std::ostream& out, const Production& production) -> std::ostream&;
 
@@ -108,8 +142,16 @@ private:
   Name m_productionName;
   bool m_contextFree = false; // Is the production context-free?
   std::unique_ptr<Predecessor> m_input;
-  std::unique_ptr<const Expression> m_condition;
-  std::unique_ptr<const List<Successor>> m_successors;
+  std::unique_ptr<Expression> m_condition;
+  std::unique_ptr<Bytecode> m_conditionCode; // Compiled m_condition, if any
+  std::unique_ptr<List<Successor>> m_successors;
+  // Successor selection table, built with the production: the running
+  // maximum of the cumulative successor probabilities, and the successors'
+  // module lists in the same order.
+  std::vector<float> m_cumulativeProbabilities{};
+  std::vector<const List<Module>*> m_successorModules{};
+  auto IndexSuccessors() -> void;
+  [[nodiscard]] auto ChooseSuccessor(float randomVar) const noexcept -> const List<Module>*;
 };
 
 } // namespace LSYS
@@ -7,7 +7,7 @@ export module LSys.RadianceGenerator;
 
 import LSys.Consts;
 import LSys.Generator;
-import LSys.Module;
+import LSys.Name;
 import LSys.Polygon;
 import LSys.Vector;
 
@@ -36,7 +36,7 @@ public:
   auto Flower(float radius) -> void;
   auto Leaf(float length) -> void;
   auto Apex(Vector& start, float length) -> void;
-  auto DrawObject(const Module& mod, int numArgs, const ArgsArray& args) -> void override;
+  auto DrawObject(const Name& name, int numArgs, const ArgsArray& args) -> void override;
 
   // Functions to change rendering parameters
   auto SetColor() -> void override;
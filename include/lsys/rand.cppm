@@ -1,16 +1,86 @@
 module;
 
-#include <functional>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
 export module LSys.Rand;
 
 export namespace LSYS
 {
 
-using GetRandDoubleInUnitIntervalFunc = std::function<double()>;
+// A xoshiro256** random number generator, seeded through splitmix64. The
+// numbers are generated a batch at a time, so the state update runs in a
+// tight loop of its own rather than once for each number drawn.
+class RandomEngine
+{
+public:
+  static constexpr auto DEFAULT_SEED = uint64_t{0};
+
+  explicit RandomEngine(uint64_t seed = DEFAULT_SEED) noexcept;
+
+  [[nodiscard]] auto GetUint64() noexcept -> uint64_t;
+  // A uniformly distributed number in [0, 1).
+  [[nodiscard]] auto GetDouble() noexcept -> double;
+
+  // Advance the engine by 2^128 numbers, discarding the rest of the batch.
+  // Engines a jump apart draw non-overlapping streams, so copies of an
+  // engine taken between jumps give each worker thread a stream of its own.
+  auto Jump() noexcept -> void;
+
+private:
+  static constexpr auto BATCH_SIZE = size_t{64};
+  std::array<uint64_t, 4> m_state{};
+  std::array<uint64_t, BATCH_SIZE> m_batch{};
+  size_t m_nextInBatch = BATCH_SIZE;
+  auto FillBatch() noexcept -> void;
+};
+
+// Make 'engine' the calling thread's engine for random numbers, returning
+// the previous one; nullptr restores the thread's default engine.
+auto SetThreadRandomEngine(RandomEngine* engine) noexcept -> RandomEngine*;
+
+// A number in [0, 1) from the calling thread's engine: the one set by
+// SetThreadRandomEngine, or else one with the default seed.
+[[nodiscard]] auto GetRandDoubleInUnitInterval() noexcept -> double;
+
+class ScopedThreadRandomEngine
+{
+public:
+  explicit ScopedThreadRandomEngine(RandomEngine& engine) noexcept
+    : m_previousEngine{SetThreadRandomEngine(&engine)}
+  {
+  }
+  ScopedThreadRandomEngine(const ScopedThreadRandomEngine&) = delete;
+  ScopedThreadRandomEngine(ScopedThreadRandomEngine&&)      = delete;
+  ~ScopedThreadRandomEngine() noexcept { SetThreadRandomEngine(m_previousEngine); }
 
-auto SetRandFunc(const GetRandDoubleInUnitIntervalFunc& getRandDoubleFunc) -> void;
+  auto operator=(const ScopedThreadRandomEngine&) -> ScopedThreadRandomEngine& = delete;
+  auto operator=(ScopedThreadRandomEngine&&) -> ScopedThreadRandomEngine&      = delete;
 
-[[nodiscard]] auto GetRandDoubleInUnitInterval() -> double;
+private:
+  RandomEngine* m_previousEngine;
+};
+
+} // namespace LSYS
+
+namespace LSYS
+{
+
+inline auto RandomEngine::GetUint64() noexcept -> uint64_t
+{
+  if (m_nextInBatch == BATCH_SIZE)
+  {
+    FillBatch();
+  }
+  return m_batch[m_nextInBatch++];
+}
+
+inline auto RandomEngine::GetDouble() noexcept -> double
+{
+  static constexpr auto MANTISSA_SHIFT = 11U;
+  static constexpr auto UNIT           = 0x1.0p-53;
+  return static_cast<double>(GetUint64() >> MANTISSA_SHIFT) * UNIT;
+}
 
 } // namespace LSYS
@@ -0,0 +1,205 @@
+module;
+
+#include <array>
+#include <cstdint>
+
+// Define LSYS_SCALAR_MATH to use the scalar fallback even where SSE is available.
+#if defined(__SSE__) and not defined(LSYS_SCALAR_MATH)
+#include <xmmintrin.h>
+#define LSYS_SSE_MATH
+#endif
+
+export module LSys.Simd;
+
+export namespace LSYS
+{
+
+// Four floats worked on a lane at a time: with one SSE instruction per
+// operation where that is available, otherwise with a scalar loop. Vectors
+// and matrix rows are padded out to four lanes to be used this way. Each
+// lane is rounded exactly as the scalar expression would be, so the two
+// implementations give identical results.
+class Float4
+{
+public:
+  static constexpr auto NUM_LANES = 4U;
+
+  Float4() = default;
+  Float4(float x, float y, float z, float w) noexcept;
+
+  [[nodiscard]] static auto Broadcast(float val) noexcept -> Float4;
+  // 'values' must point to NUM_LANES floats aligned on a 16 byte boundary.
+  [[nodiscard]] static auto Load(const float* values) noexcept -> Float4;
+  auto Store(float* values) const noexcept -> void;
+
+  [[nodiscard]] auto operator[](uint32_t i) const noexcept -> float;
+
+  friend auto operator+(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4;
+  friend auto operator-(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4;
+  friend auto operator*(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4;
+  // Lane-wise minimum and maximum, taking 'lanes2' where either lane is NaN.
+  friend auto Min(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4;
+  friend auto Max(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4;
+
+private:
+#ifdef LSYS_SSE_MATH
+  explicit Float4(const __m128 lanes) noexcept : m_lanes{lanes} {}
+  __m128 m_lanes{};
+#else
+  std::array<float, NUM_LANES> m_lanes{};
+#endif
+};
+
+} // namespace LSYS
+
+namespace LSYS
+{
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,
+//             cppcoreguidelines-pro-bounds-constant-array-index)
+
+#ifdef LSYS_SSE_MATH
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+inline Float4::Float4(const float x, const float y, const float z, const float w) noexcept
+  : m_lanes{_mm_setr_ps(x, y, z, w)}
+{
+}
+
+inline auto Float4::Broadcast(const float val) noexcept -> Float4
+{
+  return Float4{_mm_set1_ps(val)};
+}
+
+inline auto Float4::Load(const float* const values) noexcept -> Float4
+{
+  return Float4{_mm_load_ps(values)};
+}
+
+inline auto Float4::Store(float* const values) const noexcept -> void
+{
+  _mm_store_ps(values, m_lanes);
+}
+
+inline auto Float4::operator[](const uint32_t i) const noexcept -> float
+{
+  alignas(__m128) auto values = std::array<float, NUM_LANES>{};
+  Store(values.data());
+  return values[i];
+}
+
+inline auto operator+(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  return Float4{_mm_add_ps(lanes1.m_lanes, lanes2.m_lanes)};
+}
+
+inline auto operator-(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  return Float4{_mm_sub_ps(lanes1.m_lanes, lanes2.m_lanes)};
+}
+
+inline auto operator*(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  return Float4{_mm_mul_ps(lanes1.m_lanes, lanes2.m_lanes)};
+}
+
+inline auto Min(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  return Float4{_mm_min_ps(lanes1.m_lanes, lanes2.m_lanes)};
+}
+
+inline auto Max(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  return Float4{_mm_max_ps(lanes1.m_lanes, lanes2.m_lanes)};
+}
+
+#else
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+inline Float4::Float4(const float x, const float y, const float z, const float w) noexcept
+  : m_lanes{x, y, z, w}
+{
+}
+
+inline auto Float4::Broadcast(const float val) noexcept -> Float4
+{
+  return Float4{val, val, val, val};
+}
+
+inline auto Float4::Load(const float* const values) noexcept -> Float4
+{
+  return Float4{values[0], values[1], values[2], values[3]};
+}
+
+inline auto Float4::Store(float* const values) const noexcept -> void
+{
+  for (auto i = 0U; i < NUM_LANES; ++i)
+  {
+    values[i] = m_lanes[i];
+  }
+}
+
+inline auto Float4::operator[](const uint32_t i) const noexcept -> float
+{
+  return m_lanes[i];
+}
+
+inline auto operator+(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  auto sum = Float4{};
+  for (auto i = 0U; i < Float4::NUM_LANES; ++i)
+  {
+    sum.m_lanes[i] = lanes1.m_lanes[i] + lanes2.m_lanes[i];
+  }
+  return sum;
+}
+
+inline auto operator-(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  auto difference = Float4{};
+  for (auto i = 0U; i < Float4::NUM_LANES; ++i)
+  {
+    difference.m_lanes[i] = lanes1.m_lanes[i] - lanes2.m_lanes[i];
+  }
+  return difference;
+}
+
+inline auto operator*(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  auto product = Float4{};
+  for (auto i = 0U; i < Float4::NUM_LANES; ++i)
+  {
+    product.m_lanes[i] = lanes1.m_lanes[i] * lanes2.m_lanes[i];
+  }
+  return product;
+}
+
+// These match the SSE instructions, including which lane is taken for NaN.
+inline auto Min(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  auto minimum = Float4{};
+  for (auto i = 0U; i < Float4::NUM_LANES; ++i)
+  {
+    minimum.m_lanes[i] =
+        (lanes1.m_lanes[i] < lanes2.m_lanes[i]) ? lanes1.m_lanes[i] : lanes2.m_lanes[i];
+  }
+  return minimum;
+}
+
+inline auto Max(const Float4& lanes1, const Float4& lanes2) noexcept -> Float4
+{
+  auto maximum = Float4{};
+  for (auto i = 0U; i < Float4::NUM_LANES; ++i)
+  {
+    maximum.m_lanes[i] =
+        (lanes1.m_lanes[i] > lanes2.m_lanes[i]) ? lanes1.m_lanes[i] : lanes2.m_lanes[i];
+  }
+  return maximum;
+}
+
+#endif
+
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,
+//           cppcoreguidelines-pro-bounds-constant-array-index)
+
+} // namespace LSYS
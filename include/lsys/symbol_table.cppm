@@ -1,7 +1,13 @@
 module;
 
-#include <map>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 export module LSys.SymbolTable;
 
@@ -12,7 +18,7 @@ template<typename T>
 class Symbol
 {
 public:
-  Symbol(const std::string& name, const T& value) : m_tag(name), m_value(value) {}
+  Symbol(const std::string_view name, const T& value) : m_tag(name), m_value(value) {}
 
   [[nodiscard]] auto GetName() const -> const std::string& { return m_tag; }
   auto SetName(const std::string& name) -> void { m_tag = name; }
@@ -24,15 +30,30 @@ private:
   T m_value;
 };
 
+// An open addressing hash table of symbols, probed linearly, looked up by
+//  string_view so no key string need be built to look a name up.
 template<typename T>
 class SymbolTable
 {
 public:
-  auto Enter(const std::string& name, const T& value) -> bool;
-  [[nodiscard]] auto Lookup(const std::string& name, T& value) const -> bool;
+  // Bind a name. Returns true if the name was not bound already.
+  auto Enter(std::string_view name, const T& value) -> bool;
+  // Look a name up. Returns false if it is not bound.
+  [[nodiscard]] auto Lookup(std::string_view name, T& value) const -> bool;
+
+  [[nodiscard]] auto size() const noexcept -> size_t { return m_numSymbols; }
+  // Call func(name, value) for each binding.
+  template<typename Func>
+  auto ForEach(Func func) const -> void;
 
 private:
-  std::map<std::string, Symbol<T>> m_symbolTable{};
+  static constexpr auto MIN_CAPACITY = 16U;
+  std::vector<std::optional<Symbol<T>>> m_slots{};
+  size_t m_numSymbols = 0;
+
+  // Slot holding the name, or the empty slot where it would go.
+  [[nodiscard]] auto FindSlot(std::string_view name) const noexcept -> size_t;
+  auto Grow() -> void;
 };
 
 } // namespace LSYS
@@ -41,32 +62,82 @@ namespace LSYS
 {
 
 template<typename T>
-auto SymbolTable<T>::Enter(const std::string& name, const T& value) -> bool
+auto SymbolTable<T>::FindSlot(const std::string_view name) const noexcept -> size_t
+{
+  const auto mask = m_slots.size() - 1;
+  for (auto slot = std::hash<std::string_view>{}(name) & mask;; slot = (slot + 1) & mask)
+  {
+    if ((not m_slots[slot].has_value()) or (m_slots[slot]->GetName() == name))
+    {
+      return slot;
+    }
+  }
+}
+
+// Keep the table at most half full, so probe sequences stay short.
+template<typename T>
+auto SymbolTable<T>::Grow() -> void
+{
+  const auto capacity = std::max<size_t>(MIN_CAPACITY, 2 * m_slots.size());
+  auto oldSlots       = std::exchange(m_slots, std::vector<std::optional<Symbol<T>>>(capacity));
+  for (auto& symbol : oldSlots)
+  {
+    if (symbol.has_value())
+    {
+      m_slots[FindSlot(symbol->GetName())] = std::move(symbol);
+    }
+  }
+}
+
+template<typename T>
+auto SymbolTable<T>::Enter(const std::string_view name, const T& value) -> bool
 {
-  const auto iter = m_symbolTable.find(name);
+  if ((2 * (m_numSymbols + 1)) > m_slots.size())
+  {
+    Grow();
+  }
 
-  if (iter == m_symbolTable.end())
+  auto& symbol = m_slots[FindSlot(name)];
+  if (symbol.has_value())
   {
-    const auto symbol = Symbol<T>{name, value};
-    m_symbolTable.insert({name, symbol});
-    return true;
+    symbol->SetValue(value);
+    return false;
   }
 
-  iter->second.SetValue(value);
-  return false;
+  symbol.emplace(name, value);
+  ++m_numSymbols;
+  return true;
 }
 
 template<typename T>
-auto SymbolTable<T>::Lookup(const std::string& name, T& value) const -> bool
+auto SymbolTable<T>::Lookup(const std::string_view name, T& value) const -> bool
 {
-  const auto iter = m_symbolTable.find(name);
-  if (iter == m_symbolTable.end())
+  if (m_numSymbols == 0)
+  {
+    return false;
+  }
+
+  const auto& symbol = m_slots[FindSlot(name)];
+  if (not symbol.has_value())
   {
     return false;
   }
 
-  value = iter->second.GetValue();
+  value = symbol->GetValue();
   return true;
 }
 
+template<typename T>
+template<typename Func>
+auto SymbolTable<T>::ForEach(Func func) const -> void
+{
+  for (const auto& symbol : m_slots)
+  {
+    if (symbol.has_value())
+    {
+      func(std::string_view{symbol->GetName()}, symbol->GetValue());
+    }
+  }
+}
+
 } // namespace LSYS
@@ -30,9 +30,12 @@
 
 module;
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
-#include <stack>
+#include <stdexcept>
+#include <vector>
 
 export module LSys.Turtle;
 
@@ -99,19 +102,28 @@ public:
 
   [[nodiscard]] auto GetBoundingBox() const -> BoundingBox { return m_boundingBox; }
 
-  struct State
+  // The state is split into the pose, which most branches change, and the
+  // drawing attributes, which few do; Push and Pop save and restore them
+  // separately.
+  struct Pose
   {
-    Vector position{0.0F, 0.0F, 0.0F};
     Matrix frame{};
+    Vector position{0.0F, 0.0F, 0.0F};
+    float width = 1.0F;
+  };
+  struct Attributes
+  {
     float defaultDistance           = 0.0F;
     float defaultTurnAngleInRadians = MATHS::ToRadians(DEFAULT_TURN_ANGLE_DEGREES);
-    float width                     = 1.0F;
     float widthScale                = 1.0F;
     Color color;
     Color backgroundColor;
     int texture = 0;
     TropismInfo tropism{};
   };
+  struct State : Pose, Attributes
+  {
+  };
   [[nodiscard]] auto GetCurrentState() const -> const State& { return m_currentState; }
 
   auto ResetDrawingParamsToDefaults() -> void;
@@ -162,19 +174,110 @@ public:
   auto Move() -> void;
   auto Move(float distance) -> void;
 
+  // Turns and moves for a turtle that stays in the XY plane, which need
+  // only update the x and y components of the heading, left and position.
+  // They give the same results as Turn and Move, provided the turtle is
+  // planar when they start and nothing else (a pitch, roll, $ or tropism)
+  // turns it out of the plane.
+  [[nodiscard]] auto IsPlanar() const -> bool;
+  auto TurnInPlane(Direction direction) -> void;
+  auto TurnInPlane(float angle) -> void;
+  auto MoveInPlane() -> void;
+  auto MoveInPlane(float distance) -> void;
+
   auto Push() -> void;
   auto Pop() -> void;
+  // Make room for 'depth' nested pushes, e.g. the string's maximum bracket depth.
+  auto ReserveStack(size_t depth) -> void;
+
+  // For interpreting a string in chunks: a chunk can be moved from an
+  // identity pose, and its motion composed with the pose the chunks before
+  // it reach, provided nothing in it depends on the turtle's absolute frame.
+  [[nodiscard]] auto GetPoseStack() const -> const std::vector<Pose>& { return m_poseStack; }
+  auto SetPose(const Pose& pose, const std::vector<Pose>& poseStack) -> void;
+  auto ExpandBoundingBox(const BoundingBox& boundingBox) -> void;
+  // The pose reached by moving from 'pose' as 'relativePose' was reached
+  // from the identity pose.
+  [[nodiscard]] static auto ComposePoses(const Pose& pose, const Pose& relativePose) -> Pose;
 
   friend auto operator<<(std::ostream& out, const Turtle& turtle) -> std::ostream&;
 
 private:
   State m_currentState{};
-  std::stack<State> m_stateStack;
+
+  // Push saves only the pose, to a contiguous stack. The attributes are
+  // saved by SaveAttributes before the first change to them within a branch,
+  // so branches that only move and turn the turtle never copy them.
+  struct SavedAttributes
+  {
+    size_t depth; // Size of the pose stack when saved
+    Attributes attributes;
+  };
+  std::vector<Pose> m_poseStack;
+  std::vector<SavedAttributes> m_attributesStack;
+  auto SaveAttributes() -> void;
 
   BoundingBox m_boundingBox; // Bounding box of turtle path
   Vector m_gravity{0.0F, 0.0F, 0.0F}; // Antigravity vector
+
+  // Rotations by the default turn angle around each axis, in each direction,
+  // worked out when the angle changes rather than on every turn.
+  static constexpr auto NUM_DEFAULT_ROTATIONS = 6U;
+  std::array<Matrix, NUM_DEFAULT_ROTATIONS> m_defaultRotations{};
+  float m_defaultRotationsAngleInRadians = 0.0F;
+  auto UpdateDefaultRotations() -> void;
+  [[nodiscard]] auto GetDefaultRotation(Matrix::Axis axis, Direction direction) const
+      -> const Matrix&;
+
+  auto RotateInPlane(const Matrix& rotation) -> void;
 };
 
 auto operator<<(std::ostream& out, const TropismInfo& tropismInfo) -> std::ostream&;
 
 } // namespace LSYS
+
+namespace LSYS
+{
+
+inline auto Turtle::Push() -> void
+{
+  m_poseStack.push_back(static_cast<const Pose&>(m_currentState));
+}
+
+inline auto Turtle::Pop() -> void
+{
+  if (m_poseStack.empty())
+  {
+    throw std::runtime_error("Turtle::Pop: turtle stack is empty.");
+  }
+
+  if ((not m_attributesStack.empty()) and (m_attributesStack.back().depth == m_poseStack.size()))
+  {
+    static_cast<Attributes&>(m_currentState) = m_attributesStack.back().attributes;
+    m_attributesStack.pop_back();
+
+    // NOLINTNEXTLINE(clang-diagnostic-float-equal): any change needs new rotations
+    if (m_currentState.defaultTurnAngleInRadians != m_defaultRotationsAngleInRadians)
+    {
+      UpdateDefaultRotations();
+    }
+  }
+
+  static_cast<Pose&>(m_currentState) = m_poseStack.back();
+  m_poseStack.pop_back();
+}
+
+// Save the attributes, if they haven't been saved since the last Push,
+// before they are changed. Outside any branch there is nothing to restore,
+// so nothing is saved.
+inline auto Turtle::SaveAttributes() -> void
+{
+  if ((not m_poseStack.empty()) and
+      (m_attributesStack.empty() or (m_attributesStack.back().depth != m_poseStack.size())))
+  {
+    m_attributesStack.push_back(
+        {m_poseStack.size(), static_cast<const Attributes&>(m_currentState)});
+  }
+}
+
+} // namespace LSYS
@@ -0,0 +1,162 @@
+module;
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+export module LSys.ValueFrame;
+
+import LSys.Name;
+import LSys.SymbolTable;
+import LSys.Value;
+
+export namespace LSYS
+{
+
+// Names in production expressions are resolved to slots when the model is
+//  loaded: formal parameters to slots of a per-production frame, and global
+//  (#define) values to slots of a constant frame shared by all productions.
+//  Binding and evaluation then index flat arrays of values instead of
+//  looking names up in a symbol table.
+inline constexpr auto NO_SLOT = -1;
+
+// Slots given to a set of names, indexed by name id.
+class NameSlots
+{
+public:
+  // Return the slot of a name, giving it the next free slot if it has none.
+  auto Add(const Name& name) -> int;
+  [[nodiscard]] auto Find(const Name& name) const noexcept -> int;
+  [[nodiscard]] auto size() const noexcept -> size_t { return m_numSlots; }
+
+private:
+  std::vector<int> m_slotsByNameId{};
+  size_t m_numSlots = 0;
+};
+
+// The global values of a model that its productions refer to.
+class ConstantFrame
+{
+public:
+  // Slot of a global value, taken from the symbol table the first time it is
+  //  asked for; NO_SLOT if the symbol table does not define the name.
+  auto GetSlot(const Name& name, const SymbolTable<Value>& symbolTable) -> int;
+  // Keep the frame in step with a global value that has been reset.
+  auto Update(const Name& name, const Value& value) noexcept -> void;
+  [[nodiscard]] auto GetValues() const noexcept -> std::span<const Value> { return m_values; }
+
+private:
+  NameSlots m_slots{};
+  std::vector<Value> m_values{};
+};
+
+// The values an expression is evaluated against: the formal parameters bound
+//  while matching a production, the constant frame, and a symbol table for
+//  names not resolved to a slot, such as those in #define expressions.
+class ValueFrame
+{
+public:
+  explicit ValueFrame(const SymbolTable<Value>& symbolTable) noexcept;
+  ValueFrame(const SymbolTable<Value>& symbolTable,
+             std::span<const Value> constants,
+             size_t numFormals);
+
+  [[nodiscard]] auto GetSymbolTable() const noexcept -> const SymbolTable<Value>&;
+  [[nodiscard]] auto GetFormal(int slot) const noexcept -> const Value&;
+  auto SetFormal(int slot, const Value& value) noexcept -> void;
+  [[nodiscard]] auto GetConstant(int slot) const noexcept -> const Value&;
+
+private:
+  const SymbolTable<Value>* m_symbolTable;
+  std::span<const Value> m_constants{};
+  std::vector<Value> m_formals{};
+};
+
+} // namespace LSYS
+
+namespace LSYS
+{
+
+inline auto NameSlots::Add(const Name& name) -> int
+{
+  const auto nameId = static_cast<size_t>(name.id());
+  if (nameId >= m_slotsByNameId.size())
+  {
+    m_slotsByNameId.resize(nameId + 1, NO_SLOT);
+  }
+  if (m_slotsByNameId[nameId] == NO_SLOT)
+  {
+    m_slotsByNameId[nameId] = static_cast<int>(m_numSlots);
+    ++m_numSlots;
+  }
+
+  return m_slotsByNameId[nameId];
+}
+
+inline auto NameSlots::Find(const Name& name) const noexcept -> int
+{
+  const auto nameId = static_cast<size_t>(name.id());
+  return (nameId < m_slotsByNameId.size()) ? m_slotsByNameId[nameId] : NO_SLOT;
+}
+
+inline auto ConstantFrame::GetSlot(const Name& name, const SymbolTable<Value>& symbolTable) -> int
+{
+  if (const auto slot = m_slots.Find(name); slot != NO_SLOT)
+  {
+    return slot;
+  }
+
+  auto value = Value{};
+  if (not symbolTable.Lookup(name.str(), value))
+  {
+    return NO_SLOT;
+  }
+  m_values.push_back(value);
+  return m_slots.Add(name);
+}
+
+inline auto ConstantFrame::Update(const Name& name, const Value& value) noexcept -> void
+{
+  if (const auto slot = m_slots.Find(name); slot != NO_SLOT)
+  {
+    m_values[static_cast<size_t>(slot)] = value;
+  }
+}
+
+inline ValueFrame::ValueFrame(const SymbolTable<Value>& symbolTable) noexcept
+  : m_symbolTable{&symbolTable}
+{
+}
+
+inline ValueFrame::ValueFrame(const SymbolTable<Value>& symbolTable,
+                              const std::span<const Value> constants,
+                              const size_t numFormals)
+  : m_symbolTable{&symbolTable}, m_constants{constants}, m_formals(numFormals)
+{
+}
+
+inline auto ValueFrame::GetSymbolTable() const noexcept -> const SymbolTable<Value>&
+{
+  return *m_symbolTable;
+}
+
+inline auto ValueFrame::GetFormal(const int slot) const noexcept -> const Value&
+{
+  assert(static_cast<size_t>(slot) < m_formals.size());
+  return m_formals[static_cast<size_t>(slot)];
+}
+
+inline auto ValueFrame::SetFormal(const int slot, const Value& value) noexcept -> void
+{
+  assert(static_cast<size_t>(slot) < m_formals.size());
+  m_formals[static_cast<size_t>(slot)] = value;
+}
+
+inline auto ValueFrame::GetConstant(const int slot) const noexcept -> const Value&
+{
+  assert(static_cast<size_t>(slot) < m_constants.size());
+  return m_constants[static_cast<size_t>(slot)];
+}
+
+} // namespace LSYS
@@ -44,6 +44,7 @@ module;
 export module LSys.Vector;
 
 import LSys.Consts;
+import LSys.Simd;
 
 export namespace LSYS
 {
@@ -62,6 +63,13 @@ public:
 
   Vector() = default;
   Vector(const float x, const float y, const float z) : m_vec{x, y, z} {}
+  explicit Vector(const Float4& lanes) : m_vec{lanes[0], lanes[1], lanes[2]} {}
+
+  // The vector padded with a zero fourth lane.
+  [[nodiscard]] auto GetLanes() const -> Float4
+  {
+    return Float4{m_vec[0], m_vec[1], m_vec[2], 0.0F};
+  }
 
   [[nodiscard]] auto GetMagnitude() -> float
   {
@@ -180,8 +188,9 @@ inline auto Distance(const Vector& vec1, const Vector& vec2) -> float
 
 auto operator<<(std::ostream& out, const Vector& vec) -> std::ostream&;
 
-// 3x4 transformation matrix (no perspective)
-class Matrix
+// 3x4 transformation matrix (no perspective). Each row is padded to a
+// 16 byte boundary so it can be loaded as a Float4.
+class alignas(sizeof(Float4)) Matrix
 {
 public:
   enum class Initialize : uint8_t
@@ -206,6 +215,8 @@ public:
   // NOLINTEND
   auto Zero() -> Matrix&;
   auto Identity() -> Matrix&;
+  // The matrix of a rotation around 'axis' of 'angle' radians.
+  [[nodiscard]] static auto GetRotation(Axis axis, float angle) -> Matrix;
   auto Rotate(Axis axis, float angle) -> Matrix&;
   auto Rotate(const Vector& vec, float angle) -> Matrix&;
   auto Reverse() -> Matrix&;
@@ -222,18 +233,27 @@ auto operator<<(std::ostream& out, const Matrix& matrix) -> std::ostream&;
 class BoundingBox
 {
 public:
-  BoundingBox() : m_minVec{0.0F, 0.0F, 0.0F}, m_maxVec{0.0F, 0.0F, 0.0F} {}
-  explicit BoundingBox(const Vector& vec) : m_minVec{vec}, m_maxVec{vec} {}
+  BoundingBox() = default;
+  explicit BoundingBox(const Vector& vec) : m_minVec{vec.GetLanes()}, m_maxVec{vec.GetLanes()} {}
 
-  auto Expand(const Vector& point) -> void;
-  [[nodiscard]] auto Min() const -> Vector { return m_minVec; }
-  [[nodiscard]] auto Max() const -> Vector { return m_maxVec; }
+  auto Expand(const Vector& point) -> void { Expand(point.GetLanes()); }
+  auto Expand(const Float4& point) -> void;
+  [[nodiscard]] auto Min() const -> Vector { return Vector{m_minVec}; }
+  [[nodiscard]] auto Max() const -> Vector { return Vector{m_maxVec}; }
 
 private:
-  Vector m_minVec;
-  Vector m_maxVec;
+  Float4 m_minVec;
+  Float4 m_maxVec;
 };
 
+// Expand the box to include the specified point. A NaN coordinate leaves
+// the box unchanged, since Min and Max take their second lane for NaN.
+inline auto BoundingBox::Expand(const Float4& point) -> void
+{
+  m_minVec = LSYS::Min(point, m_minVec);
+  m_maxVec = LSYS::Max(point, m_maxVec);
+}
+
 auto operator<<(std::ostream& out, const BoundingBox& boundingBox) -> std::ostream&;
 
 // NOLINTEND(cppcoreguidelines-pro-bounds-constant-array-index)
@@ -156,7 +156,8 @@ CommandLineOptions::OptionReturnCode CommandLineOptions::ProcessOptions(int argc
     optionDefinitions[i]  = strdup(str.c_str());
     optionDescriptions[i] = strdup(cmdOptions[i]->OptDescription().c_str());
   }
-  optionDefinitions[cmdOptions.size()] = nullptr;
+  optionDefinitions[cmdOptions.size()]  = nullptr;
+  optionDescriptions[cmdOptions.size()] = nullptr;
 
   argv++;
   argc--;
@@ -40,10 +40,28 @@
  */
 #include "command_line_options.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 import LSys.Generator;
 import LSys.GenericGenerator;
@@ -51,22 +69,22 @@ import LSys.Interpret;
 import LSys.List;
 import LSys.LSysModel;
 import LSys.Module;
+import LSys.ModuleString;
 import LSys.ParsedModel;
 import LSys.RadianceGenerator;
-import LSys.Rand;
 import LSys.Value;
 
 using LSYS::GenericGenerator;
 using LSYS::GetFinalProperties;
 using LSYS::IGenerator;
 using LSYS::Interpreter;
-using LSYS::List;
 using LSYS::LSysModel;
-using LSYS::Module;
+using LSYS::ModuleString;
 using LSYS::Properties;
 using LSYS::RadianceGenerator;
 using LSYS::SetParserDebug;
-using LSYS::SetRandFunc;
+using LSYS::Value;
+using LSYS::WriteCompiledModel;
 using Utilities::CommandLineOptions;
 
 using OptionTypes      = Utilities::CommandLineOptions::OptionTypes;
@@ -79,10 +97,19 @@ struct CommandLineArgs
 {
   bool success = false;
   Properties properties{};
-  const char* outputFilename = "";
-  const char* boundsFilename = "";
-  bool display               = false;
-  bool stats                 = false;
+  const char* outputFilename   = "";
+  const char* boundsFilename   = "";
+  const char* compiledFilename = "";
+  const char* sweepFilename    = "";
+  const char* batchDirectory   = "";
+  std::vector<std::string> batchInputs{};
+  int numJobs                  = 0;
+  bool display                 = false;
+  bool stats                   = false;
+  int numThreads               = 1;
+  bool composeChunks           = false;
+  bool stream                  = false;
+  bool predict                 = false;
 };
 
 // Return a copy of a filename stripped of its trailing extension.
@@ -165,6 +192,24 @@ cerr << "    m - main program loop\n"
   static constexpr const auto* STATS_DESCR    = "displays module statistics for each generation";
   static constexpr const auto* OUTPUT_DESCR   = "output filename";
   static constexpr const auto* BOUNDS_DESCR   = "bounds filename";
+  static constexpr const auto* THREADS_DESCR =
+      "number of threads used to generate each generation and interpret the last";
+  static constexpr const auto* COMPOSE_DESCR =
+      "with -t, composes chunk start states from turtle motions; output may round differently";
+  static constexpr const auto* STREAM_DESCR =
+      "interpret context-free models depth first without storing the final generation";
+  static constexpr const auto* PREDICT_DESCR =
+      "predicts module counts and memory for each generation of a D0L model, without generating";
+  static constexpr const auto* COMPILE_DESCR =
+      "writes the model as a compiled model, which loads faster than the model text";
+  static constexpr const auto* SWEEP_DESCR =
+      "CSV file of argument values, one output per row, named by the header row";
+  static constexpr const auto* BATCH_DESCR =
+      "output directory; renders every input file to <dir>/<input name>.out and .bnds";
+  static constexpr const auto* SEED_DESCR =
+      "seed for stochastic productions and rand(); a seed always gives the same output";
+  static constexpr const auto* JOBS_DESCR =
+      "number of sweep points or batch files run at once (default: cores)";
 
   auto help1 = false;
   auto help2 = false;
@@ -176,6 +221,13 @@ cerr << "    m - main program loop\n"
   cmdOpts.Add('H', "help", HELP_DESCR, OptionTypes::NO_ARGS, &help2);
   cmdOpts.Add(' ', "display", DISPLAY_DESCR, OptionTypes::NO_ARGS, &commandLineArgs.display);
   cmdOpts.Add(' ', "stats", STATS_DESCR, OptionTypes::NO_ARGS, &commandLineArgs.stats);
+  cmdOpts.Add(' ', "stream", STREAM_DESCR, OptionTypes::NO_ARGS, &commandLineArgs.stream);
+  cmdOpts.Add(' ',
+              "compose-chunks",
+              COMPOSE_DESCR,
+              OptionTypes::NO_ARGS,
+              &commandLineArgs.composeChunks);
+  cmdOpts.Add(' ', "predict", PREDICT_DESCR, OptionTypes::NO_ARGS, &commandLineArgs.predict);
   cmdOpts.Add('m',
               "maxgen <int>",
               MAX_GEN_DESCR,
@@ -206,10 +258,36 @@ cerr << "    m - main program loop\n"
               BOUNDS_DESCR,
               OptionTypes::REQUIRED_ARG,
               &commandLineArgs.boundsFilename);
+  cmdOpts.Add('t',
+              "threads <int>",
+              THREADS_DESCR,
+              OptionTypes::REQUIRED_ARG,
+              &commandLineArgs.numThreads);
+  cmdOpts.Add(' ',
+              "seed <int>",
+              SEED_DESCR,
+              OptionTypes::REQUIRED_ARG,
+              &commandLineArgs.properties.seed);
+  cmdOpts.Add(' ',
+              "compile <string>",
+              COMPILE_DESCR,
+              OptionTypes::REQUIRED_ARG,
+              &commandLineArgs.compiledFilename);
+  cmdOpts.Add(' ',
+              "sweep <string>",
+              SWEEP_DESCR,
+              OptionTypes::REQUIRED_ARG,
+              &commandLineArgs.sweepFilename);
+  cmdOpts.Add(' ',
+              "batch <string>",
+              BATCH_DESCR,
+              OptionTypes::REQUIRED_ARG,
+              &commandLineArgs.batchDirectory);
+  cmdOpts.Add('j', "jobs <int>", JOBS_DESCR, OptionTypes::REQUIRED_ARG, &commandLineArgs.numJobs);
   //  cmdOpts.Add(' ', "generic", noArgs, &generic);
 
   std::vector<std::string> positionalParams{};
-  cmdOpts.SetPositional(1, 1, &positionalParams);
+  cmdOpts.SetPositional(1, std::numeric_limits<int>::max(), &positionalParams);
 
   if (const CommandLineOptions::OptionReturnCode retCode = cmdOpts.ProcessOptions(argc, argv);
       retCode != OptionReturnCode::OK)
@@ -232,7 +310,15 @@ cerr << "    m - main program loop\n"
     cmdOpts.Usage(std::cerr, "input file...");
     return commandLineArgs;
   }
+  if ((*commandLineArgs.batchDirectory == '\0') and (positionalParams.size() > 1))
+  {
+    std::cerr << "\n";
+    std::cerr << "Only --batch takes more than one input file\n\n";
+    cmdOpts.Usage(std::cerr, "input file...");
+    return commandLineArgs;
+  }
   commandLineArgs.properties.inputFilename = positionalParams[0];
+  commandLineArgs.batchInputs              = std::move(positionalParams);
 
   commandLineArgs.success = true;
 
@@ -252,18 +338,41 @@ auto PrintStartInfo(const LSysModel& model, const bool display, const bool stats
 }
 
 auto PrintGenInfo(const int gen,
-                  const List<Module>& moduleList,
+                  const ModuleString& modules,
                   const bool display,
                   const bool stats) -> void
 {
   if (display)
   {
-    std::cout << "Gen " << gen << ": " << moduleList << "\n";
+    std::cout << "Gen " << gen << ": " << modules << "\n";
   }
   if (stats)
   {
     std::cerr << "Gen " << std::setw(3) << gen << ": # modules= " << std::setw(5)
-              << moduleList.size() << "\n";
+              << modules.size() << "\n";
+  }
+}
+
+// Generating a generation needs both it and the previous one in memory.
+auto PrintPredictedSizes(const std::vector<LSysModel::GenerationSize>& sizes) -> void
+{
+  static constexpr auto BYTES_PER_MB = 1024.0 * 1024.0;
+
+  const auto getMemoryInMb = [](const LSysModel::GenerationSize& size)
+  {
+    return ((static_cast<double>(size.numModules) * ModuleString::BYTES_PER_MODULE) +
+            (static_cast<double>(size.numValues) * ModuleString::BYTES_PER_VALUE)) /
+           BYTES_PER_MB;
+  };
+
+  for (auto gen = 0U; gen < sizes.size(); ++gen)
+  {
+    const auto memory     = getMemoryInMb(sizes[gen]);
+    const auto peakMemory = (0 == gen) ? memory : memory + getMemoryInMb(sizes[gen - 1]);
+    std::cout << "Gen " << std::setw(3) << gen << ": # modules= " << std::setw(5)
+              << sizes[gen].numModules << "  # values= " << std::setw(5) << sizes[gen].numValues
+              << "  memory= " << std::fixed << std::setprecision(2) << memory
+              << " MB  peak= " << peakMemory << " MB\n";
   }
 }
 
@@ -275,6 +384,395 @@ auto PrintInterpretStart(const std::string& header) -> void
   std::cerr << "\n";
 }
 
+// Generate the model's final generation and interpret it to the output
+// and bounds files.
+auto GenerateAndInterpret(LSysModel& model,
+                          const Properties& finalProperties,
+                          const std::string& outputFilename,
+                          const std::string& boundsFilename,
+                          const CommandLineArgs& cmdArgs,
+                          const bool printProgress) -> void
+{
+  auto generator   = GetGenerator(finalProperties, outputFilename, boundsFilename);
+  auto interpreter = Interpreter(*generator);
+  interpreter.SetDefaults(
+      {finalProperties.turnAngle, finalProperties.lineWidth, finalProperties.lineDistance});
+
+  if (cmdArgs.stream and (not model.IsContextFree()))
+  {
+    std::cerr << "Model has context sensitive rules; cannot stream, generating in full.\n";
+  }
+  if (cmdArgs.stream and model.IsContextFree())
+  {
+    // Each module of the final generation goes to the interpreter as soon as
+    // it is derived, so no generation is held in memory.
+    if (printProgress)
+    {
+      PrintInterpretStart(generator->GetHeader());
+    }
+    interpreter.StartStream();
+    model.DeriveStream(*model.GetStartModuleString(),
+                       finalProperties.maxGen,
+                       [&interpreter](const ModuleString& modules)
+                       { interpreter.InterpretStream(modules); });
+    interpreter.FinishStream();
+    return;
+  }
+
+  // For each generation, apply appropriate productions in parallel to all modules.
+  if (printProgress)
+  {
+    PrintStartInfo(model, cmdArgs.display, cmdArgs.stats);
+  }
+  // Each generation is built in one buffer while the previous one is read
+  // from the other; the buffers are then swapped and reused.
+  auto modules     = model.GetStartModuleString();
+  auto nextModules = std::make_unique<ModuleString>();
+  for (int gen = 1; gen <= finalProperties.maxGen; ++gen)
+  {
+    model.Generate(*modules, *nextModules);
+    std::swap(modules, nextModules);
+    if (printProgress)
+    {
+      PrintGenInfo(gen, *modules, cmdArgs.display, cmdArgs.stats);
+    }
+  }
+  nextModules.reset();
+
+  // Apply the output generator to the final module list.
+  if (printProgress)
+  {
+    PrintInterpretStart(generator->GetHeader());
+  }
+  interpreter.SetNumThreads(model.GetNumThreads());
+  interpreter.SetComposeChunks(cmdArgs.composeChunks);
+  interpreter.InterpretAllModules(*modules);
+}
+
+// Call task(i) for each i in [0, numTasks) on a pool of up to numJobs
+// threads, including the calling one; 0 jobs means one per core.
+auto RunJobs(const int numJobs, const size_t numTasks, const std::function<void(size_t)>& task)
+    -> void
+{
+  const auto numThreads = (numJobs > 0) ? static_cast<size_t>(numJobs)
+                                        : std::max(1U, std::thread::hardware_concurrency());
+
+  auto nextTask       = std::atomic<size_t>{0};
+  const auto runTasks = [&nextTask, numTasks, &task]()
+  {
+    for (auto i = nextTask++; i < numTasks; i = nextTask++)
+    {
+      task(i);
+    }
+  };
+
+  auto workers = std::vector<std::jthread>{};
+  for (auto i = 1U; i < std::min(numThreads, numTasks); ++i)
+  {
+    workers.emplace_back(runTasks);
+  }
+  runTasks();
+}
+
+// Run a job and report its status and time. Returns false if the job
+// threw, which fails the job but not the others.
+[[nodiscard]] auto RunJob(const std::string& description, const std::function<void()>& job)
+    -> bool
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  static auto s_reportMutex = std::mutex{};
+
+  const auto start = std::chrono::steady_clock::now();
+  auto status      = std::string{"ok"};
+  auto succeeded   = true;
+  try
+  {
+    job();
+  }
+  catch (const std::exception& e)
+  {
+    status    = std::string{"failed: "} + e.what();
+    succeeded = false;
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const auto lock = std::scoped_lock{s_reportMutex};
+  std::cerr << description << ": " << status << ", "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms\n";
+  return succeeded;
+}
+
+// A parameter sweep: the argument names from the header row of a CSV file,
+// and the argument values of each point from the rows that follow.
+struct SweepGrid
+{
+  std::vector<std::string> names;
+  std::vector<std::vector<Value>> points;
+};
+
+[[nodiscard]] auto GetCsvFields(const std::string& line) -> std::vector<std::string>
+{
+  static constexpr auto WHITESPACE = " \t\r";
+
+  auto fields      = std::vector<std::string>{};
+  auto fieldStream = std::istringstream{line};
+  for (auto field = std::string{}; std::getline(fieldStream, field, ',');)
+  {
+    const auto start = field.find_first_not_of(WHITESPACE);
+    const auto end   = field.find_last_not_of(WHITESPACE);
+    fields.emplace_back((start == std::string::npos) ? "" : field.substr(start, end - start + 1));
+  }
+  return fields;
+}
+
+// An integer field is an int value, as it would be in the model text.
+[[nodiscard]] auto GetSweepValue(const std::string_view field) -> Value
+{
+  if (field.empty())
+  {
+    throw std::runtime_error("Sweep value is missing.");
+  }
+
+  const auto* const first = field.data();
+  const auto* const last  = field.data() + field.size();
+
+  if (auto intValue = 0; std::from_chars(first, last, intValue).ptr == last)
+  {
+    return Value{intValue};
+  }
+  if (auto fltValue = 0.0F; std::from_chars(first, last, fltValue).ptr == last)
+  {
+    return Value{fltValue};
+  }
+  throw std::runtime_error("Sweep value '" + std::string{field} + "' is not a number.");
+}
+
+// Blank lines and lines starting with '#' are skipped.
+[[nodiscard]] auto GetSweepGrid(const std::string& filename) -> SweepGrid
+{
+  auto sweepFile = std::ifstream{filename};
+  if (not sweepFile.good())
+  {
+    std::cerr << "Could not open sweep file '" << filename << "'.\n";
+    throw std::runtime_error("Could not open sweep file.");
+  }
+
+  auto grid = SweepGrid{};
+  for (auto line = std::string{}; std::getline(sweepFile, line);)
+  {
+    auto fields = GetCsvFields(line);
+    if (fields.empty() or ((fields.size() == 1) and fields[0].empty()) or
+        fields[0].starts_with('#'))
+    {
+      continue;
+    }
+    if (grid.names.empty())
+    {
+      grid.names = std::move(fields);
+      continue;
+    }
+    if (fields.size() != grid.names.size())
+    {
+      throw std::runtime_error("Sweep file row " + std::to_string(grid.points.size() + 1) +
+                               " does not have a value for each argument.");
+    }
+    auto& values = grid.points.emplace_back();
+    std::ranges::transform(fields, std::back_inserter(values), GetSweepValue);
+  }
+  return grid;
+}
+
+// Set the arguments of a sweep point. The maxgen, delta, width and distance
+// arguments set the properties as the command line does; every argument
+// also resets the #define of that name.
+auto SetSweepArguments(LSysModel& model,
+                       Properties& properties,
+                       const std::vector<std::string>& names,
+                       const std::vector<Value>& values) -> void
+{
+  for (auto i = 0U; i < names.size(); ++i)
+  {
+    const auto& name  = names[i];
+    const auto& value = values[i];
+
+    auto isProperty = true;
+    auto isValid    = true;
+    if (name == "maxgen")
+    {
+      isValid = value.GetIntValue(properties.maxGen);
+    }
+    else if (name == "delta")
+    {
+      isValid = value.GetFloatValue(properties.turnAngle);
+    }
+    else if (name == "width")
+    {
+      isValid = value.GetFloatValue(properties.lineWidth);
+    }
+    else if (name == "distance")
+    {
+      isValid = value.GetFloatValue(properties.lineDistance);
+    }
+    else
+    {
+      isProperty = false;
+    }
+    if (not isValid)
+    {
+      throw std::runtime_error("Invalid value specified for " + name + ".");
+    }
+
+    if (Value oldValue; model.GetSymbolTable().Lookup(name, oldValue))
+    {
+      model.ResetArgument(name, value);
+    }
+    else if (not isProperty)
+    {
+      throw std::runtime_error("Sweep argument '" + name + "' is not defined by the model.");
+    }
+  }
+}
+
+// The output filename of a sweep point: 'tree.out' becomes 'tree_3.out'.
+[[nodiscard]] auto GetSweepFilename(const std::string& filename, const size_t pointNum)
+    -> std::string
+{
+  auto path = std::filesystem::path{filename};
+  path.replace_filename(path.stem().string() + "_" + std::to_string(pointNum) +
+                        path.extension().string());
+  return path.string();
+}
+
+// Generate and interpret each point of the sweep from a clone of the model,
+// sharing its rules, running points on a pool of worker threads.
+[[nodiscard]] auto RunSweep(const LSysModel& model, const CommandLineArgs& cmdArgs) -> int
+{
+  const auto grid      = GetSweepGrid(cmdArgs.sweepFilename);
+  const auto numPoints = grid.points.size();
+  auto numFailed       = std::atomic<size_t>{0};
+
+  RunJobs(cmdArgs.numJobs,
+          numPoints,
+          [&](const size_t point)
+          {
+            const auto outputFilename = GetSweepFilename(cmdArgs.outputFilename, point + 1);
+            const auto boundsFilename = GetSweepFilename(cmdArgs.boundsFilename, point + 1);
+            const auto description =
+                "Point " + std::to_string(point + 1) + " (" + outputFilename + ")";
+            const auto succeeded = RunJob(
+                description,
+                [&]()
+                {
+                  auto pointModel = model.Clone();
+                  auto properties = cmdArgs.properties;
+                  SetSweepArguments(*pointModel, properties, grid.names, grid.points[point]);
+                  const auto finalProperties =
+                      GetFinalProperties(pointModel->GetSymbolTable(), properties);
+                  GenerateAndInterpret(
+                      *pointModel, finalProperties, outputFilename, boundsFilename, cmdArgs, false);
+                });
+            if (not succeeded)
+            {
+              ++numFailed;
+            }
+          });
+
+  std::cerr << numPoints << " points, " << numFailed << " failed.\n";
+  return (numFailed == 0) ? 0 : 1;
+}
+
+// The input files of a batch: a directory stands for the files in it, in
+// name order, and '@file' for the files listed in 'file', one per line.
+[[nodiscard]] auto GetBatchFilenames(const std::vector<std::string>& inputs)
+    -> std::vector<std::string>
+{
+  auto filenames = std::vector<std::string>{};
+  for (const auto& input : inputs)
+  {
+    if (input.starts_with('@'))
+    {
+      auto listFile = std::ifstream{input.substr(1)};
+      if (not listFile.good())
+      {
+        std::cerr << "Could not open batch list file '" << input.substr(1) << "'.\n";
+        throw std::runtime_error("Could not open batch list file.");
+      }
+      for (auto line = std::string{}; std::getline(listFile, line);)
+      {
+        if (not line.empty())
+        {
+          filenames.emplace_back(line);
+        }
+      }
+    }
+    else if (std::filesystem::is_directory(input))
+    {
+      auto directoryFilenames = std::vector<std::string>{};
+      for (const auto& entry : std::filesystem::directory_iterator{input})
+      {
+        if (entry.is_regular_file())
+        {
+          directoryFilenames.emplace_back(entry.path().string());
+        }
+      }
+      std::ranges::sort(directoryFilenames);
+      std::ranges::move(directoryFilenames, std::back_inserter(filenames));
+    }
+    else
+    {
+      filenames.emplace_back(input);
+    }
+  }
+  return filenames;
+}
+
+// Parse, generate and interpret every input file of the batch in this one
+// process, running files on a pool of worker threads. Outputs are named as
+// run-example.sh names them.
+[[nodiscard]] auto RunBatch(const CommandLineArgs& cmdArgs) -> int
+{
+  const auto outputDirectory = std::filesystem::path{cmdArgs.batchDirectory};
+  if (not std::filesystem::is_directory(outputDirectory))
+  {
+    std::cerr << "Could not find output directory '" << cmdArgs.batchDirectory << "'.\n";
+    throw std::runtime_error("Could not find output directory.");
+  }
+
+  const auto filenames = GetBatchFilenames(cmdArgs.batchInputs);
+  auto numFailed       = std::atomic<size_t>{0};
+
+  RunJobs(cmdArgs.numJobs,
+          filenames.size(),
+          [&](const size_t i)
+          {
+            const auto succeeded = RunJob(
+                filenames[i],
+                [&]()
+                {
+                  auto properties          = cmdArgs.properties;
+                  properties.inputFilename = filenames[i];
+
+                  const auto model = GetParsedModel(properties);
+                  model->SetNumThreads(static_cast<uint32_t>(std::max(1, cmdArgs.numThreads)));
+
+                  const auto inputName = std::filesystem::path{filenames[i]}.filename().string();
+                  GenerateAndInterpret(*model,
+                                       GetFinalProperties(model->GetSymbolTable(), properties),
+                                       (outputDirectory / (inputName + ".out")).string(),
+                                       (outputDirectory / (inputName + ".bnds")).string(),
+                                       cmdArgs,
+                                       false);
+                });
+            if (not succeeded)
+            {
+              ++numFailed;
+            }
+          });
+
+  std::cerr << filenames.size() << " files, " << numFailed << " failed.\n";
+  return (numFailed == 0) ? 0 : 1;
+}
+
 } // namespace
 
 int main(const int argc, const char* argv[])
@@ -289,29 +787,38 @@ int main(const int argc, const char* argv[])
       return 1;
     }
 
-    // Initialize random number generator.
-    ::srand48(::time(nullptr));
-    SetRandFunc([]() { return static_cast<double>(rand()) / static_cast<double>(RAND_MAX); });
+    if (*cmdArgs.batchDirectory != '\0')
+    {
+      return RunBatch(cmdArgs);
+    }
+
+    const auto model = GetParsedModel(cmdArgs.properties);
+    if (*cmdArgs.compiledFilename != '\0')
+    {
+      WriteCompiledModel(*model, cmdArgs.compiledFilename);
+      return 0;
+    }
+    model->SetNumThreads(static_cast<uint32_t>(std::max(1, cmdArgs.numThreads)));
+
+    if (*cmdArgs.sweepFilename != '\0')
+    {
+      return RunSweep(*model, cmdArgs);
+    }
 
-    const auto model           = GetParsedModel(cmdArgs.properties);
     const auto finalProperties = GetFinalProperties(model->GetSymbolTable(), cmdArgs.properties);
 
-    // For each generation, apply appropriate productions in parallel to all modules.
-    PrintStartInfo(*model, cmdArgs.display, cmdArgs.stats);
-    auto moduleList = std::make_unique<List<Module>>(*model->GetStartModuleList());
-    for (int gen = 1; gen <= finalProperties.maxGen; ++gen)
+    if (cmdArgs.predict)
     {
-      moduleList = model->Generate(moduleList.get());
-      PrintGenInfo(gen, *moduleList, cmdArgs.display, cmdArgs.stats);
+      PrintPredictedSizes(model->PredictGenerationSizes(finalProperties.maxGen));
+      return 0;
     }
 
-    // Construct an output generator and apply it to the final module list.
-    auto generator = GetGenerator(finalProperties, cmdArgs.outputFilename, cmdArgs.boundsFilename);
-    PrintInterpretStart(generator->GetHeader());
-    auto interpreter = Interpreter(*generator);
-    interpreter.SetDefaults(
-        {finalProperties.turnAngle, finalProperties.lineWidth, finalProperties.lineDistance});
-    interpreter.InterpretAllModules(*moduleList);
+    GenerateAndInterpret(*model,
+                         finalProperties,
+                         cmdArgs.outputFilename,
+                         cmdArgs.boundsFilename,
+                         cmdArgs,
+                         true);
 
     return 0;
   }
@@ -362,7 +362,7 @@ void Options::Controls(const char* flagsStr)
 OptionSpec Options::MatchOpt(char opt, int ignore_case) const
 {
   if ((optvec == nullptr) || (!*optvec))
-    return OptionSpec("", "");
+    return OptionSpec(nullptr, nullptr);
 
   int i = 0;
   while (optvec[i] != nullptr)
@@ -382,7 +382,7 @@ OptionSpec Options::MatchOpt(char opt, int ignore_case) const
     }
   }
 
-  return OptionSpec("", ""); // not found
+  return OptionSpec(nullptr, nullptr); // not found
 }
 
 
@@ -429,11 +429,11 @@ OptionSpec Options::MatchOpt(char opt, int ignore_case) const
 OptionSpec Options::MatchLongOpt(const char* opt, int len, int& ambiguous) const
 {
   kwdmatch_t result;
-  OptionSpec matched("", "");
+  OptionSpec matched(nullptr, nullptr);
 
   ambiguous = 0;
   if ((optvec == nullptr) || (!*optvec))
-    return OptionSpec("", "");
+    return OptionSpec(nullptr, nullptr);
 
   int i = 0;
   while (optvec[i] != nullptr)
@@ -457,7 +457,7 @@ OptionSpec Options::MatchLongOpt(const char* opt, int len, int& ambiguous) const
       else
       {
         ++ambiguous;
-        return OptionSpec("", ""); // not found
+        return OptionSpec(nullptr, nullptr); // not found
       }
     }
   }
@@ -915,7 +915,8 @@ kwdmatch_t kwdmatch(const char* src, const char* attempt, int len)
       return NO_MATCH;
   }
 
-  return (src[i]) ? PARTIAL_MATCH : EXACT_MATCH;
+  // The long-option may be followed by a space and its argument description.
+  return (src[i] && (src[i] != ' ')) ? PARTIAL_MATCH : EXACT_MATCH;
 }
 
 } // namespace
@@ -304,13 +304,13 @@ public:
   int ExplicitEndOpts() const { return explicitEnd; }
 
 private:
-  unsigned explicitEnd : 1; // were we terminated because of "--"?
-  unsigned optctrls : 7; // control settings (a set of OptCtrl masks)
-  const char* const* optvec; // vector of option-specifications (last=NULL)
-  const char* const* optDesc; // vector of option-descriptions (must match optvec)
-  const char* nextchar; // next option-character to process
-  const char* listopt; // last list-option we matched
-  const char* cmdname; // name of the command
+  unsigned explicitEnd : 1 = 0; // were we terminated because of "--"?
+  unsigned optctrls : 7    = Default; // control settings (a set of OptCtrl masks)
+  const char* const* optvec  = nullptr; // vector of option-specifications (last=NULL)
+  const char* const* optDesc = nullptr; // vector of option-descriptions (must match optvec)
+  const char* nextchar       = nullptr; // next option-character to process
+  const char* listopt        = nullptr; // last list-option we matched
+  const char* cmdname        = nullptr; // name of the command
   void CheckSyntax() const;
   OptionSpec MatchOpt(char opt, int ignore_case = 0) const;
   OptionSpec MatchLongOpt(const char* opt, int len, int& ambiguous) const;
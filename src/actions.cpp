@@ -40,8 +40,8 @@ module LSys.Actions;
 
 import LSys.Consts;
 import LSys.Generator;
-import LSys.List;
 import LSys.Module;
+import LSys.ModuleString;
 import LSys.Polygon;
 import LSys.Turtle;
 import LSys.Vector;
@@ -56,35 +56,52 @@ namespace
 // get quite deep in recursive L-system productions, thus we use a depth
 // of 100 (probably should use a dynamically allocated list).
 constexpr auto MAX_POLYGONS = 100;
-// NOLINTNEXTLINE(cert-err58-cpp, cppcoreguidelines-avoid-non-const-global-variables)
-std::stack<LSYS::Polygon> polygonStack;
 
-enum class State : uint8_t
+using State = ActionContext::State;
+
+// Whether the motion actions may use the turtle's planar turns and moves.
+enum class Motion : uint8_t
 {
-  START,
-  DRAWING,
-  POLYGON
+  SPATIAL,
+  PLANAR
 };
-// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-auto state = State::START;
 
+template<Motion MOTION>
 auto MoveTurtle(Turtle& turtle, const int numArgs, const ArgsArray& args) noexcept -> void
 {
-  if (0 == numArgs)
+  if constexpr (MOTION == Motion::PLANAR)
   {
-    turtle.Move();
+    if (0 == numArgs)
+    {
+      turtle.MoveInPlane();
+    }
+    else
+    {
+      turtle.MoveInPlane(args[0]);
+    }
   }
   else
   {
-    turtle.Move(args[0]);
+    if (0 == numArgs)
+    {
+      turtle.Move();
+    }
+    else
+    {
+      turtle.Move(args[0]);
+    }
   }
 }
 
 // Add an edge to the current polygon while moving
-auto AddPolygonEdge(Turtle& turtle, const int numArgs, const ArgsArray& args) noexcept -> void
+template<Motion MOTION>
+auto AddPolygonEdge(ActionContext& context,
+                    Turtle& turtle,
+                    const int numArgs,
+                    const ArgsArray& args) noexcept -> void
 {
   // Add an edge to the current polygon
-  const auto& lastPolygon = polygonStack.top();
+  const auto& lastPolygon = context.polygonStack.top();
 
   // See if the starting point needs to be added (only if
   // it's different from the last point defined in
@@ -94,85 +111,85 @@ auto AddPolygonEdge(Turtle& turtle, const int numArgs, const ArgsArray& args) no
       lastPolygon.empty() or (lastPolygon.back() != point))
   {
     PDebug(PD_INTERPRET, std::cerr << "AddPolygonEdge: adding first vertex " << point << "\n");
-    polygonStack.top().emplace_back(point);
+    context.polygonStack.top().emplace_back(point);
   }
 
   // Move and add the ending point to the polygon.
-  MoveTurtle(turtle, numArgs, args);
+  MoveTurtle<MOTION>(turtle, numArgs, args);
   PDebug(PD_INTERPRET,
          std::cerr << "AddPolygonEdge: adding last vertex  " << turtle.GetCurrentState().position
                    << "\n");
-  polygonStack.top().emplace_back(turtle.GetCurrentState().position);
+  context.polygonStack.top().emplace_back(turtle.GetCurrentState().position);
 }
 
 // Set line width only if changed too much
-auto SetLineWidth(const Turtle& turtle, IGenerator& generator) noexcept -> void
+auto SetLineWidth(ActionContext& context, const Turtle& turtle, IGenerator& generator) noexcept
+    -> void
 {
   static constexpr auto EPSILON = 1e-6F;
-  static float s_lastLineWidth  = -1.0F;
 
   // Don't bother changing line width if 'small enough'.
   // This is an optimization to handle e.g. !(w)[!(w/2)F][!(w/2)F]
   //sort of cases, which happen a lot with trees.
-  if (std::fabs(turtle.GetCurrentState().width - s_lastLineWidth) < EPSILON)
+  if (std::fabs(turtle.GetCurrentState().width - context.lastLineWidth) < EPSILON)
   {
     return;
   }
 
-  if (state == State::DRAWING)
+  if (context.state == State::DRAWING)
   {
     generator.FlushGraphics();
-    state = State::START;
+    context.state = State::START;
   }
 
   generator.SetWidth();
-  s_lastLineWidth = turtle.GetCurrentState().width;
+  context.lastLineWidth = turtle.GetCurrentState().width;
 }
 
 // Set color only if changed
-auto SetColor(const Turtle& turtle, IGenerator& generator) noexcept -> void
+auto SetColor(ActionContext& context, const Turtle& turtle, IGenerator& generator) noexcept
+    -> void
 {
-  static Color s_lastColor(-1);
-
   // Don't change color if not needed, again an optimization
-  if (turtle.GetCurrentState().color == s_lastColor)
+  if (turtle.GetCurrentState().color == context.lastColor)
   {
     return;
   }
 
-  if (state == State::DRAWING)
+  if (context.state == State::DRAWING)
   {
     generator.FlushGraphics();
-    state = State::START;
+    context.state = State::START;
   }
 
   generator.SetColor();
-  s_lastColor = turtle.GetCurrentState().color;
+  context.lastColor = turtle.GetCurrentState().color;
 }
 
 // Set texture only if changed
-auto SetTexture(const Turtle& turtle, IGenerator& generator) noexcept -> void
+auto SetTexture(ActionContext& context, const Turtle& turtle, IGenerator& generator) noexcept
+    -> void
 {
-  static int s_lastTexture(-1);
-
   // Don't change texture if not needed, again an optimization
-  if (turtle.GetCurrentState().texture == s_lastTexture)
+  if (turtle.GetCurrentState().texture == context.lastTexture)
   {
     return;
   }
 
-  if (state == State::DRAWING)
+  if (context.state == State::DRAWING)
   {
     generator.FlushGraphics();
-    state = State::START;
+    context.state = State::START;
   }
 
   generator.SetTexture();
-  s_lastTexture = turtle.GetCurrentState().texture;
+  context.lastTexture = turtle.GetCurrentState().texture;
 }
 
 // f(l) Move without drawing
-auto MoveImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto MoveImpl(ActionContext& context,
+              [[maybe_unused]] const ModuleStringIterator& moduleIter,
               Turtle& turtle,
               IGenerator& generator,
               const int numArgs,
@@ -180,20 +197,22 @@ auto MoveImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 {
   PDebug(PD_INTERPRET, std::cerr << "Move          \n");
 
-  if ((state == State::DRAWING) or (state == State::START))
+  if ((context.state == State::DRAWING) or (context.state == State::START))
   {
-    MoveTurtle(turtle, numArgs, args);
+    MoveTurtle<MOTION>(turtle, numArgs, args);
     generator.MoveTo();
   }
   else
   {
-    assert(state == State::POLYGON);
-    AddPolygonEdge(turtle, numArgs, args);
+    assert(context.state == State::POLYGON);
+    AddPolygonEdge<MOTION>(context, turtle, numArgs, args);
   }
 }
 
 // z Move half standard distance without drawing
-auto MoveHalfImpl(const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto MoveHalfImpl(ActionContext& context,
+                  const ModuleStringIterator& moduleIter,
                   Turtle& turtle,
                   IGenerator& generator,
                   [[maybe_unused]] const int numArgs,
@@ -202,12 +221,14 @@ auto MoveHalfImpl(const ConstListIterator<Module>& moduleIter,
   PDebug(PD_INTERPRET, std::cerr << "MoveHalf      \n");
 
   const ArgsArray oneArg = {0.5F * turtle.GetCurrentState().defaultDistance};
-  MoveImpl(moduleIter, turtle, generator, 1, oneArg);
+  MoveImpl<MOTION>(context, moduleIter, turtle, generator, 1, oneArg);
 }
 
 // F(l) Move while drawing
 // Fr(l), Fl(l) - Right and GetLeft edges respectively
-auto DrawImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto DrawImpl(ActionContext& context,
+              [[maybe_unused]] const ModuleStringIterator& moduleIter,
               Turtle& turtle,
               IGenerator& generator,
               const int numArgs,
@@ -215,26 +236,28 @@ auto DrawImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 {
   PDebug(PD_INTERPRET, std::cerr << "Draw          \n");
 
-  if (state == State::START)
+  if (context.state == State::START)
   {
     generator.StartGraphics();
-    state = State::DRAWING;
+    context.state = State::DRAWING;
   }
 
-  if (state == State::DRAWING)
+  if (context.state == State::DRAWING)
   {
-    MoveTurtle(turtle, numArgs, args);
+    MoveTurtle<MOTION>(turtle, numArgs, args);
     generator.LineTo();
   }
   else
   {
-    assert(state == State::POLYGON);
-    AddPolygonEdge(turtle, numArgs, args);
+    assert(context.state == State::POLYGON);
+    AddPolygonEdge<MOTION>(context, turtle, numArgs, args);
   }
 }
 
 // Z Draw half standard distance while drawing
-auto DrawHalfImpl(const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto DrawHalfImpl(ActionContext& context,
+                  const ModuleStringIterator& moduleIter,
                   Turtle& turtle,
                   IGenerator& generator,
                   [[maybe_unused]] const int numArgs,
@@ -243,11 +266,12 @@ auto DrawHalfImpl(const ConstListIterator<Module>& moduleIter,
   PDebug(PD_INTERPRET, std::cerr << "DrawHalf      \n");
 
   const auto oneArg = ArgsArray{0.5F * turtle.GetCurrentState().defaultDistance};
-  DrawImpl(moduleIter, turtle, generator, 1, oneArg);
+  DrawImpl<MOTION>(context, moduleIter, turtle, generator, 1, oneArg);
 }
 
 // -(t) Turn right: NEGATIVE rotation about Z
-auto TurnRightImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto TurnRightImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    [[maybe_unused]] const IGenerator& generator,
                    const int numArgs,
@@ -255,18 +279,33 @@ auto TurnRightImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 {
   PDebug(PD_INTERPRET, std::cerr << "TurnRight     \n");
 
-  if (0 == numArgs)
+  if constexpr (MOTION == Motion::PLANAR)
   {
-    turtle.Turn(Turtle::Direction::NEGATIVE);
+    if (0 == numArgs)
+    {
+      turtle.TurnInPlane(Turtle::Direction::NEGATIVE);
+    }
+    else
+    {
+      turtle.TurnInPlane(-MATHS::ToRadians(args[0]));
+    }
   }
   else
   {
-    turtle.Turn(-MATHS::ToRadians(args[0]));
+    if (0 == numArgs)
+    {
+      turtle.Turn(Turtle::Direction::NEGATIVE);
+    }
+    else
+    {
+      turtle.Turn(-MATHS::ToRadians(args[0]));
+    }
   }
 }
 
 // +(t) Turn left; POSITIVE rotation about Z
-auto TurnLeftImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto TurnLeftImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                   Turtle& turtle,
                   [[maybe_unused]] const IGenerator& generator,
                   const int numArgs,
@@ -274,18 +313,32 @@ auto TurnLeftImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 {
   PDebug(PD_INTERPRET, std::cerr << "TurnLeft      \n");
 
-  if (0 == numArgs)
+  if constexpr (MOTION == Motion::PLANAR)
   {
-    turtle.Turn(Turtle::Direction::POSITIVE);
+    if (0 == numArgs)
+    {
+      turtle.TurnInPlane(Turtle::Direction::POSITIVE);
+    }
+    else
+    {
+      turtle.TurnInPlane(MATHS::ToRadians(args[0]));
+    }
   }
   else
   {
-    turtle.Turn(MATHS::ToRadians(args[0]));
+    if (0 == numArgs)
+    {
+      turtle.Turn(Turtle::Direction::POSITIVE);
+    }
+    else
+    {
+      turtle.Turn(MATHS::ToRadians(args[0]));
+    }
   }
 }
 
 // ^(t) Pitch up; NEGATIVE rotation about Y
-auto PitchUpImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto PitchUpImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  [[maybe_unused]] const IGenerator& generator,
                  const int numArgs,
@@ -304,7 +357,7 @@ auto PitchUpImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 }
 
 // &(t) Pitch down; POSITIVE rotation about Y
-auto PitchDownImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto PitchDownImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    [[maybe_unused]] const IGenerator& generator,
                    const int numArgs,
@@ -323,7 +376,7 @@ auto PitchDownImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 }
 
 // /(t) Roll right; POSITIVE rotation about X
-auto RollRightImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto RollRightImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    [[maybe_unused]] const IGenerator& generator,
                    const int numArgs,
@@ -342,7 +395,7 @@ auto RollRightImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 }
 
 // \(t) Roll left; NEGATIVE rotation about X
-auto RollLeftImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto RollLeftImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                   Turtle& turtle,
                   [[maybe_unused]] const IGenerator& generator,
                   const int numArgs,
@@ -361,7 +414,7 @@ auto RollLeftImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 }
 
 // |  Turn around
-auto ReverseImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto ReverseImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  [[maybe_unused]] const IGenerator& generator,
                  [[maybe_unused]] const int numArgs,
@@ -373,7 +426,7 @@ auto ReverseImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 }
 
 // [  Push turtle state
-auto PushImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto PushImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
               Turtle& turtle,
               [[maybe_unused]] const IGenerator& generator,
               [[maybe_unused]] const int numArgs,
@@ -385,7 +438,8 @@ auto PushImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 }
 
 // ] Pop turtle state
-auto PopImpl(ConstListIterator<Module>& moduleIter,
+auto PopImpl(ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              IGenerator& generator,
              [[maybe_unused]] const int numArgs,
@@ -400,13 +454,12 @@ auto PopImpl(ConstListIterator<Module>& moduleIter,
   // This is an optimization to handle deep nesting ([[...][...[...]]]),
   // which happens a lot with trees.
 
-  const Module* const obj = moduleIter.next();
-  if (obj != nullptr)
+  if (moduleIter.next())
   {
-    if (not IsRightBracket(obj->GetName()))
+    if (not IsRightBracket(moduleIter.GetName()))
     {
-      SetLineWidth(turtle, generator);
-      SetColor(turtle, generator);
+      SetLineWidth(context, turtle, generator);
+      SetColor(context, turtle, generator);
       generator.MoveTo();
     }
     // Back off one step so the next module is interpreted properly
@@ -415,7 +468,7 @@ auto PopImpl(ConstListIterator<Module>& moduleIter,
 }
 
 // $ Roll to horizontal plane (pg. 57)
-auto RollHorizontalImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto RollHorizontalImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                         Turtle& turtle,
                         [[maybe_unused]] const IGenerator& generator,
                         [[maybe_unused]] const int numArgs,
@@ -427,29 +480,31 @@ auto RollHorizontalImpl([[maybe_unused]] const ConstListIterator<Module>& module
 }
 
 // {	Start a new polygon
-auto StartPolygonImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto StartPolygonImpl(ActionContext& context,
+                      [[maybe_unused]] const ModuleStringIterator& moduleIter,
                       IGenerator& generator,
                       [[maybe_unused]] const int numArgs,
                       [[maybe_unused]] const ArgsArray& args) -> void
 {
   PDebug(PD_INTERPRET, std::cerr << "StartPolygon  \n");
 
-  if (state == State::DRAWING)
+  if (context.state == State::DRAWING)
   {
     generator.FlushGraphics();
   }
 
-  state = State::POLYGON;
-  if (polygonStack.size() > MAX_POLYGONS)
+  context.state = State::POLYGON;
+  if (context.polygonStack.size() > MAX_POLYGONS)
   {
     throw std::runtime_error("StartPolygon: polygon stack filled.");
   }
 
-  polygonStack.emplace();
+  context.polygonStack.emplace();
 }
 
 // .	Add a vertex to the current polygon
-auto PolygonVertexImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto PolygonVertexImpl(ActionContext& context,
+                       [[maybe_unused]] const ModuleStringIterator& moduleIter,
                        const Turtle& turtle,
                        [[maybe_unused]] const IGenerator& generator,
                        [[maybe_unused]] const int numArgs,
@@ -457,18 +512,18 @@ auto PolygonVertexImpl([[maybe_unused]] const ConstListIterator<Module>& moduleI
 {
   PDebug(PD_INTERPRET, std::cerr << "PolygonVertex \n");
 
-  if (state != State::POLYGON)
+  if (context.state != State::POLYGON)
   {
     throw std::runtime_error("PolygonVertexImpl: Add polygon vertex while not in polygon mode.");
   }
 
-  if (polygonStack.empty())
+  if (context.polygonStack.empty())
   {
     throw std::runtime_error("PolygonVertexImpl: no polygon being defined.");
   }
-  assert(polygonStack.size() <= MAX_POLYGONS);
+  assert(context.polygonStack.size() <= MAX_POLYGONS);
 
-  polygonStack.top().emplace_back(turtle.GetCurrentState().position);
+  context.polygonStack.top().emplace_back(turtle.GetCurrentState().position);
 }
 
 // G	Move without creating a polygon edge
@@ -476,7 +531,8 @@ auto PolygonVertexImpl([[maybe_unused]] const ConstListIterator<Module>& moduleI
 // the rose leaf example in the text uses G in this context.
 // Until the behavior is specified, just Move the turtle without
 // other effects.
-auto PolygonMoveImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+template<Motion MOTION>
+auto PolygonMoveImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                      Turtle& turtle,
                      [[maybe_unused]] const IGenerator& generator,
                      const int numArgs,
@@ -489,38 +545,39 @@ auto PolygonMoveImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIte
   //	  return;
   //}
 
-  MoveTurtle(turtle, numArgs, args);
+  MoveTurtle<MOTION>(turtle, numArgs, args);
 }
 
 // }	Close the current polygon
-auto EndPolygonImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto EndPolygonImpl(ActionContext& context,
+                    [[maybe_unused]] const ModuleStringIterator& moduleIter,
                     IGenerator& generator,
                     [[maybe_unused]] const int numArgs,
                     [[maybe_unused]] const ArgsArray& args) -> void
 {
   PDebug(PD_INTERPRET, std::cerr << "EndPolygon    \n");
 
-  if ((state != State::POLYGON) or (polygonStack.empty()))
+  if ((context.state != State::POLYGON) or (context.polygonStack.empty()))
   {
     throw std::runtime_error("EndPolygonImpl: no polygon being defined.");
   }
 
-  if (polygonStack.size() > MAX_POLYGONS)
+  if (context.polygonStack.size() > MAX_POLYGONS)
   {
     throw std::runtime_error("EndPolygon: polygon stack too deep, polygon lost.");
   }
 
-  generator.Polygon(polygonStack.top());
-  polygonStack.pop();
+  generator.Polygon(context.polygonStack.top());
+  context.polygonStack.pop();
   // Return to start state if no more polys on stack
-  if (polygonStack.empty())
+  if (context.polygonStack.empty())
   {
-    state = State::START;
+    context.state = State::START;
   }
 }
 
 // @md(f) Multiply GetDefaultDistance by f
-auto MultiplyDefaultDistanceImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto MultiplyDefaultDistanceImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                                  Turtle& turtle,
                                  [[maybe_unused]] const IGenerator& generator,
                                  const int numArgs,
@@ -540,7 +597,7 @@ auto MultiplyDefaultDistanceImpl([[maybe_unused]] const ConstListIterator<Module
 }
 
 // @ma(f) Multiply GetDefaultTurnAngle by f
-auto MultiplyDefaultTurnAngleImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto MultiplyDefaultTurnAngleImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                                   Turtle& turtle,
                                   [[maybe_unused]] const IGenerator& generator,
                                   const int numArgs,
@@ -563,7 +620,8 @@ auto MultiplyDefaultTurnAngleImpl([[maybe_unused]] const ConstListIterator<Modul
 }
 
 // @mw(f) Multiply width by f
-auto MultiplyWidthImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto MultiplyWidthImpl(ActionContext& context,
+                       [[maybe_unused]] const ModuleStringIterator& moduleIter,
                        Turtle& turtle,
                        IGenerator& generator,
                        const int numArgs,
@@ -581,11 +639,12 @@ auto MultiplyWidthImpl([[maybe_unused]] const ConstListIterator<Module>& moduleI
     turtle.SetWidth(args[0] * turtle.GetCurrentState().width);
   }
 
-  SetLineWidth(turtle, generator);
+  SetLineWidth(context, turtle, generator);
 }
 
 // !(d) Set line width
-auto ChangeWidthImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto ChangeWidthImpl(ActionContext& context,
+                     [[maybe_unused]] const ModuleStringIterator& moduleIter,
                      Turtle& turtle,
                      IGenerator& generator,
                      const int numArgs,
@@ -602,13 +661,14 @@ auto ChangeWidthImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIte
     turtle.SetWidth(args[0]);
   }
 
-  SetLineWidth(turtle, generator);
+  SetLineWidth(context, turtle, generator);
 }
 
 // '	Increment color index
 // '(n) Set color index
 // '(r,g,b) Set RGB color
-auto ChangeColorImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto ChangeColorImpl(ActionContext& context,
+                     [[maybe_unused]] const ModuleStringIterator& moduleIter,
                      Turtle& turtle,
                      IGenerator& generator,
                      const int numArgs,
@@ -633,11 +693,12 @@ auto ChangeColorImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIte
     turtle.IncrementColor();
   }
 
-  SetColor(turtle, generator);
+  SetColor(context, turtle, generator);
 }
 
 // @Tx(n)	Change texture index
-auto ChangeTextureImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto ChangeTextureImpl(ActionContext& context,
+                       [[maybe_unused]] const ModuleStringIterator& moduleIter,
                        Turtle& turtle,
                        IGenerator& generator,
                        [[maybe_unused]] const int numArgs,
@@ -647,32 +708,28 @@ auto ChangeTextureImpl([[maybe_unused]] const ConstListIterator<Module>& moduleI
 
   turtle.SetTexture(static_cast<int>(args[0]));
 
-  SetTexture(turtle, generator);
+  SetTexture(context, turtle, generator);
 }
 
 // ~	Draw the following object at the turtle's position and frame
 // Needs a standardized object file format for this.
 // Should leave graphics mode before drawing object.
-auto DrawObjectImpl(const ConstListIterator<Module>& moduleIter,
+auto DrawObjectImpl(const ModuleStringIterator& moduleIter,
                     IGenerator& generator,
                     const int numArgs,
                     const ArgsArray& args) noexcept -> void
 {
   PDebug(PD_INTERPRET, std::cerr << "DrawObject    \n");
 
-  //  Module* obj= mi.next();
-  const Module* const obj = moduleIter.current();
-  if (obj != nullptr)
+  if (not moduleIter.AtEnd())
   {
-    generator.DrawObject(*obj, numArgs, args);
+    generator.DrawObject(moduleIter.GetName(), numArgs, args);
   }
 }
 
 // %	Truncate a branch
-// E.g., ignore all modules up to the next ]
-// Note that this code is cloned from right-context
-// matching in Production::matches()
-auto CutBranchImpl(ConstListIterator<Module>& moduleIter,
+// E.g., ignore all modules up to the ] closing the current branch.
+auto CutBranchImpl(ModuleStringIterator& moduleIter,
                    [[maybe_unused]] const Turtle& turtle,
                    [[maybe_unused]] const IGenerator& generator,
                    [[maybe_unused]] const int numArgs,
@@ -681,30 +738,9 @@ auto CutBranchImpl(ConstListIterator<Module>& moduleIter,
   PDebug(PD_INTERPRET, std::cerr << "CutBranch     \n");
 
   // Must find a matching ]; skip anything else including
-  //	bracketed substrings.
-  const Module* obj{};
-  int brackets = 0;
-  for (brackets = 0, obj = moduleIter.next(); obj; obj = moduleIter.next())
-  {
-    if (IsRightBracket(obj->GetName()))
-    {
-      --brackets;
-      if (0 == brackets)
-      {
-        break;
-      }
-    }
-    else if (IsLeftBracket(obj->GetName()))
-    {
-      ++brackets;
-    }
-  }
-
-  // Back off one step so the pop itself is handled by interpret()
-  if (obj != nullptr)
-  {
-    moduleIter.previous();
-  }
+  //	bracketed substrings. The iterator is left one step before
+  //	the ] so the pop itself is handled by interpret().
+  moduleIter.CutBranch();
 }
 
 // t	Enable/disable tropism corrections after each Move
@@ -713,7 +749,7 @@ auto CutBranchImpl(ConstListIterator<Module>& moduleIter,
 // t(0)       - disable tropism
 // t(1)       - re-enable tropism with last (T,e) parameters
 
-auto TropismImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
+auto TropismImpl([[maybe_unused]] const ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  [[maybe_unused]] const IGenerator& generator,
                  const int numArgs,
@@ -753,43 +789,88 @@ auto TropismImpl([[maybe_unused]] const ConstListIterator<Module>& moduleIter,
 
 } // namespace
 
-auto Move(ConstListIterator<Module>& moduleIter,
+auto Move(ActionContext& context,
+          ModuleStringIterator& moduleIter,
           Turtle& turtle,
           IGenerator& generator,
           const int numArgs,
           const ArgsArray& args) noexcept -> void
 {
-  MoveImpl(moduleIter, turtle, generator, numArgs, args);
+  MoveImpl<Motion::SPATIAL>(context, moduleIter, turtle, generator, numArgs, args);
+}
+
+auto MoveInPlane(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
+                 Turtle& turtle,
+                 IGenerator& generator,
+                 const int numArgs,
+                 const ArgsArray& args) noexcept -> void
+{
+  MoveImpl<Motion::PLANAR>(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto MoveHalf(ConstListIterator<Module>& moduleIter,
+auto MoveHalf(ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               IGenerator& generator,
               const int numArgs,
               const ArgsArray& args) noexcept -> void
 {
-  MoveHalfImpl(moduleIter, turtle, generator, numArgs, args);
+  MoveHalfImpl<Motion::SPATIAL>(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto Draw(ConstListIterator<Module>& moduleIter,
+auto MoveHalfInPlane(ActionContext& context,
+                     ModuleStringIterator& moduleIter,
+                     Turtle& turtle,
+                     IGenerator& generator,
+                     const int numArgs,
+                     const ArgsArray& args) noexcept -> void
+{
+  MoveHalfImpl<Motion::PLANAR>(context, moduleIter, turtle, generator, numArgs, args);
+}
+
+auto Draw(ActionContext& context,
+          ModuleStringIterator& moduleIter,
           Turtle& turtle,
           IGenerator& generator,
           const int numArgs,
           const ArgsArray& args) noexcept -> void
 {
-  DrawImpl(moduleIter, turtle, generator, numArgs, args);
+  DrawImpl<Motion::SPATIAL>(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto DrawHalf(ConstListIterator<Module>& moduleIter,
+auto DrawInPlane(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
+                 Turtle& turtle,
+                 IGenerator& generator,
+                 const int numArgs,
+                 const ArgsArray& args) noexcept -> void
+{
+  DrawImpl<Motion::PLANAR>(context, moduleIter, turtle, generator, numArgs, args);
+}
+
+auto DrawHalf(ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               IGenerator& generator,
               const int numArgs,
               const ArgsArray& args) noexcept -> void
 {
-  DrawHalfImpl(moduleIter, turtle, generator, numArgs, args);
+  DrawHalfImpl<Motion::SPATIAL>(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto DrawObject(ConstListIterator<Module>& moduleIter,
+auto DrawHalfInPlane(ActionContext& context,
+                     ModuleStringIterator& moduleIter,
+                     Turtle& turtle,
+                     IGenerator& generator,
+                     const int numArgs,
+                     const ArgsArray& args) noexcept -> void
+{
+  DrawHalfImpl<Motion::PLANAR>(context, moduleIter, turtle, generator, numArgs, args);
+}
+
+auto DrawObject([[maybe_unused]] const ActionContext& context,
+                ModuleStringIterator& moduleIter,
                 [[maybe_unused]] const Turtle& turtle,
                 IGenerator& generator,
                 const int numArgs,
@@ -798,7 +879,8 @@ auto DrawObject(ConstListIterator<Module>& moduleIter,
   DrawObjectImpl(moduleIter, generator, numArgs, args);
 }
 
-auto GeneralisedCylinderStart([[maybe_unused]] ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderStart([[maybe_unused]] const ActionContext& context,
+                              [[maybe_unused]] ModuleStringIterator& moduleIter,
                               [[maybe_unused]] Turtle& turtle,
                               [[maybe_unused]] IGenerator& generator,
                               [[maybe_unused]] const int numArgs,
@@ -807,7 +889,8 @@ auto GeneralisedCylinderStart([[maybe_unused]] ConstListIterator<Module>& module
   // Not implemented
 }
 
-auto GeneralisedCylinderControlPoint([[maybe_unused]] ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderControlPoint([[maybe_unused]] const ActionContext& context,
+                                     [[maybe_unused]] ModuleStringIterator& moduleIter,
                                      [[maybe_unused]] Turtle& turtle,
                                      [[maybe_unused]] IGenerator& generator,
                                      [[maybe_unused]] const int numArgs,
@@ -816,7 +899,8 @@ auto GeneralisedCylinderControlPoint([[maybe_unused]] ConstListIterator<Module>&
   // Not implemented
 }
 
-auto GeneralisedCylinderEnd([[maybe_unused]] ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderEnd([[maybe_unused]] const ActionContext& context,
+                            [[maybe_unused]] ModuleStringIterator& moduleIter,
                             [[maybe_unused]] Turtle& turtle,
                             [[maybe_unused]] IGenerator& generator,
                             [[maybe_unused]] const int numArgs,
@@ -825,7 +909,8 @@ auto GeneralisedCylinderEnd([[maybe_unused]] ConstListIterator<Module>& moduleIt
   // Not implemented
 }
 
-auto GeneralisedCylinderTangents([[maybe_unused]] ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderTangents([[maybe_unused]] const ActionContext& context,
+                                 [[maybe_unused]] ModuleStringIterator& moduleIter,
                                  [[maybe_unused]] Turtle& turtle,
                                  [[maybe_unused]] IGenerator& generator,
                                  [[maybe_unused]] const int numArgs,
@@ -834,7 +919,8 @@ auto GeneralisedCylinderTangents([[maybe_unused]] ConstListIterator<Module>& mod
   // Not implemented
 }
 
-auto GeneralisedCylinderTangentLengths([[maybe_unused]] ConstListIterator<Module>& moduleIter,
+auto GeneralisedCylinderTangentLengths([[maybe_unused]] const ActionContext& context,
+                                       [[maybe_unused]] ModuleStringIterator& moduleIter,
                                        [[maybe_unused]] Turtle& turtle,
                                        [[maybe_unused]] IGenerator& generator,
                                        [[maybe_unused]] const int numArgs,
@@ -843,25 +929,48 @@ auto GeneralisedCylinderTangentLengths([[maybe_unused]] ConstListIterator<Module
   // Not implemented
 }
 
-auto TurnRight(ConstListIterator<Module>& moduleIter,
+auto TurnRight([[maybe_unused]] const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                Turtle& turtle,
                const IGenerator& generator,
                const int numArgs,
                const ArgsArray& args) noexcept -> void
 {
-  TurnRightImpl(moduleIter, turtle, generator, numArgs, args);
+  TurnRightImpl<Motion::SPATIAL>(moduleIter, turtle, generator, numArgs, args);
+}
+
+auto TurnRightInPlane([[maybe_unused]] const ActionContext& context,
+                      ModuleStringIterator& moduleIter,
+                      Turtle& turtle,
+                      const IGenerator& generator,
+                      const int numArgs,
+                      const ArgsArray& args) noexcept -> void
+{
+  TurnRightImpl<Motion::PLANAR>(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto TurnLeft(ConstListIterator<Module>& moduleIter,
+auto TurnLeft([[maybe_unused]] const ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               const IGenerator& generator,
               const int numArgs,
               const ArgsArray& args) noexcept -> void
 {
-  TurnLeftImpl(moduleIter, turtle, generator, numArgs, args);
+  TurnLeftImpl<Motion::SPATIAL>(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto PitchUp(ConstListIterator<Module>& moduleIter,
+auto TurnLeftInPlane([[maybe_unused]] const ActionContext& context,
+                     ModuleStringIterator& moduleIter,
+                     Turtle& turtle,
+                     const IGenerator& generator,
+                     const int numArgs,
+                     const ArgsArray& args) noexcept -> void
+{
+  TurnLeftImpl<Motion::PLANAR>(moduleIter, turtle, generator, numArgs, args);
+}
+
+auto PitchUp([[maybe_unused]] const ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              const IGenerator& generator,
              const int numArgs,
@@ -870,7 +979,8 @@ auto PitchUp(ConstListIterator<Module>& moduleIter,
   PitchUpImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto PitchDown(ConstListIterator<Module>& moduleIter,
+auto PitchDown([[maybe_unused]] const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                Turtle& turtle,
                const IGenerator& generator,
                const int numArgs,
@@ -879,7 +989,8 @@ auto PitchDown(ConstListIterator<Module>& moduleIter,
   PitchDownImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto RollRight(ConstListIterator<Module>& moduleIter,
+auto RollRight([[maybe_unused]] const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                Turtle& turtle,
                const IGenerator& generator,
                const int numArgs,
@@ -888,7 +999,8 @@ auto RollRight(ConstListIterator<Module>& moduleIter,
   RollRightImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto RollLeft(ConstListIterator<Module>& moduleIter,
+auto RollLeft([[maybe_unused]] const ActionContext& context,
+              ModuleStringIterator& moduleIter,
               Turtle& turtle,
               const IGenerator& generator,
               const int numArgs,
@@ -897,7 +1009,8 @@ auto RollLeft(ConstListIterator<Module>& moduleIter,
   RollLeftImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto Reverse(ConstListIterator<Module>& moduleIter,
+auto Reverse([[maybe_unused]] const ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              const IGenerator& generator,
              const int numArgs,
@@ -906,7 +1019,8 @@ auto Reverse(ConstListIterator<Module>& moduleIter,
   ReverseImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto RollHorizontal(ConstListIterator<Module>& moduleIter,
+auto RollHorizontal([[maybe_unused]] const ActionContext& context,
+                    ModuleStringIterator& moduleIter,
                     Turtle& turtle,
                     const IGenerator& generator,
                     const int numArgs,
@@ -915,7 +1029,8 @@ auto RollHorizontal(ConstListIterator<Module>& moduleIter,
   RollHorizontalImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto Push(ConstListIterator<Module>& moduleIter,
+auto Push([[maybe_unused]] const ActionContext& context,
+          ModuleStringIterator& moduleIter,
           Turtle& turtle,
           const IGenerator& generator,
           const int numArgs,
@@ -924,16 +1039,18 @@ auto Push(ConstListIterator<Module>& moduleIter,
   PushImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto Pop(ConstListIterator<Module>& moduleIter,
+auto Pop(ActionContext& context,
+         ModuleStringIterator& moduleIter,
          Turtle& turtle,
          IGenerator& generator,
          const int numArgs,
          const ArgsArray& args) noexcept -> void
 {
-  PopImpl(moduleIter, turtle, generator, numArgs, args);
+  PopImpl(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto CutBranch(ConstListIterator<Module>& moduleIter,
+auto CutBranch([[maybe_unused]] const ActionContext& context,
+               ModuleStringIterator& moduleIter,
                const Turtle& turtle,
                const IGenerator& generator,
                const int numArgs,
@@ -942,7 +1059,8 @@ auto CutBranch(ConstListIterator<Module>& moduleIter,
   CutBranchImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto MultiplyDefaultDistance(ConstListIterator<Module>& moduleIter,
+auto MultiplyDefaultDistance([[maybe_unused]] const ActionContext& context,
+                             ModuleStringIterator& moduleIter,
                              Turtle& turtle,
                              const IGenerator& generator,
                              const int numArgs,
@@ -951,7 +1069,8 @@ auto MultiplyDefaultDistance(ConstListIterator<Module>& moduleIter,
   MultiplyDefaultDistanceImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto MultiplyDefaultTurnAngle(ConstListIterator<Module>& moduleIter,
+auto MultiplyDefaultTurnAngle([[maybe_unused]] const ActionContext& context,
+                              ModuleStringIterator& moduleIter,
                               Turtle& turtle,
                               const IGenerator& generator,
                               const int numArgs,
@@ -960,79 +1079,98 @@ auto MultiplyDefaultTurnAngle(ConstListIterator<Module>& moduleIter,
   MultiplyDefaultTurnAngleImpl(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto MultiplyWidth(ConstListIterator<Module>& moduleIter,
+auto MultiplyWidth(ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    IGenerator& generator,
                    const int numArgs,
                    const ArgsArray& args) noexcept -> void
 {
-  MultiplyWidthImpl(moduleIter, turtle, generator, numArgs, args);
+  MultiplyWidthImpl(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto ChangeWidth(ConstListIterator<Module>& moduleIter,
+auto ChangeWidth(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  IGenerator& generator,
                  const int numArgs,
                  const ArgsArray& args) noexcept -> void
 {
-  ChangeWidthImpl(moduleIter, turtle, generator, numArgs, args);
+  ChangeWidthImpl(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto ChangeColor(ConstListIterator<Module>& moduleIter,
+auto ChangeColor(ActionContext& context,
+                 ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  IGenerator& generator,
                  const int numArgs,
                  const ArgsArray& args) noexcept -> void
 {
-  ChangeColorImpl(moduleIter, turtle, generator, numArgs, args);
+  ChangeColorImpl(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto ChangeTexture(ConstListIterator<Module>& moduleIter,
+auto ChangeTexture(ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    Turtle& turtle,
                    IGenerator& generator,
                    const int numArgs,
                    const ArgsArray& args) noexcept -> void
 {
-  ChangeTextureImpl(moduleIter, turtle, generator, numArgs, args);
+  ChangeTextureImpl(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto StartPolygon(ConstListIterator<Module>& moduleIter,
+auto StartPolygon(ActionContext& context,
+                  ModuleStringIterator& moduleIter,
                   [[maybe_unused]] const Turtle& turtle,
                   IGenerator& generator,
                   const int numArgs,
                   const ArgsArray& args) -> void
 {
-  StartPolygonImpl(moduleIter, generator, numArgs, args);
+  StartPolygonImpl(context, moduleIter, generator, numArgs, args);
 }
 
-auto PolygonVertex(ConstListIterator<Module>& moduleIter,
+auto PolygonVertex(ActionContext& context,
+                   ModuleStringIterator& moduleIter,
                    const Turtle& turtle,
                    const IGenerator& generator,
                    const int numArgs,
                    const ArgsArray& args) -> void
 {
-  PolygonVertexImpl(moduleIter, turtle, generator, numArgs, args);
+  PolygonVertexImpl(context, moduleIter, turtle, generator, numArgs, args);
 }
 
-auto PolygonMove(ConstListIterator<Module>& moduleIter,
+auto PolygonMove([[maybe_unused]] const ActionContext& context,
+                 ModuleStringIterator& moduleIter,
                  Turtle& turtle,
                  const IGenerator& generator,
                  const int numArgs,
                  const ArgsArray& args) noexcept -> void
 {
-  PolygonMoveImpl(moduleIter, turtle, generator, numArgs, args);
+  PolygonMoveImpl<Motion::SPATIAL>(moduleIter, turtle, generator, numArgs, args);
+}
+
+auto PolygonMoveInPlane([[maybe_unused]] const ActionContext& context,
+                        ModuleStringIterator& moduleIter,
+                        Turtle& turtle,
+                        const IGenerator& generator,
+                        const int numArgs,
+                        const ArgsArray& args) noexcept -> void
+{
+  PolygonMoveImpl<Motion::PLANAR>(moduleIter, turtle, generator, numArgs, args);
 }
 
-auto EndPolygon(ConstListIterator<Module>& moduleIter,
+auto EndPolygon(ActionContext& context,
+                ModuleStringIterator& moduleIter,
                 [[maybe_unused]] const Turtle& turtle,
                 IGenerator& generator,
                 const int numArgs,
                 const ArgsArray& args) -> void
 {
-  EndPolygonImpl(moduleIter, generator, numArgs, args);
+  EndPolygonImpl(context, moduleIter, generator, numArgs, args);
 }
 
-auto Tropism(ConstListIterator<Module>& moduleIter,
+auto Tropism([[maybe_unused]] const ActionContext& context,
+             ModuleStringIterator& moduleIter,
              Turtle& turtle,
              const IGenerator& generator,
              const int numArgs,
@@ -0,0 +1,232 @@
+module;
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+module LSys.Bytecode;
+
+import LSys.Name;
+import LSys.Value;
+import LSys.ValueFrame;
+
+namespace LSYS
+{
+
+auto Bytecode::Emit(const OpCode opCode,
+                    const int operand,
+                    const size_t numArgs,
+                    const size_t numPopped) -> void
+{
+  if (numArgs > std::numeric_limits<uint8_t>::max())
+  {
+    throw std::runtime_error("Bytecode: too many function arguments.");
+  }
+  assert(numPopped <= m_depth);
+
+  m_code.push_back(
+      {.opCode = opCode, .numArgs = static_cast<uint8_t>(numArgs), .operand = operand});
+  m_depth    = (m_depth - numPopped) + 1;
+  m_maxDepth = std::max(m_maxDepth, m_depth);
+}
+
+auto Bytecode::EmitValue(const Value& value) -> void
+{
+  m_values.push_back(value);
+  Emit(OpCode::PUSH_VALUE, static_cast<int>(m_values.size() - 1), 0, 0);
+}
+
+auto Bytecode::EmitFormal(const int slot) -> void
+{
+  Emit(OpCode::PUSH_FORMAL, slot, 0, 0);
+}
+
+auto Bytecode::EmitConstant(const int slot) -> void
+{
+  Emit(OpCode::PUSH_CONSTANT, slot, 0, 0);
+}
+
+auto Bytecode::EmitName(const Name& name) -> void
+{
+  Emit(OpCode::PUSH_NAME, name.id(), 0, 0);
+}
+
+auto Bytecode::EmitCall(const BuiltinFunc func, const size_t numArgs) -> void
+{
+  m_functions.push_back(func);
+  Emit(OpCode::CALL, static_cast<int>(m_functions.size() - 1), numArgs, numArgs);
+}
+
+auto Bytecode::EmitUnknownFunction(const Name& name) -> void
+{
+  Emit(OpCode::UNKNOWN_FUNCTION, name.id(), 0, 0);
+}
+
+auto Bytecode::EmitOperator(const OpCode opCode) -> void
+{
+  switch (opCode)
+  {
+    case OpCode::NEGATE:
+    case OpCode::COMPLEMENT:
+    case OpCode::NOT:
+      Emit(opCode, 0, 0, 1);
+      return;
+    case OpCode::BITWISE_AND:
+    case OpCode::BITWISE_OR:
+    case OpCode::AND:
+    case OpCode::OR:
+    case OpCode::EQ:
+    case OpCode::NE:
+    case OpCode::LT:
+    case OpCode::LE:
+    case OpCode::GE:
+    case OpCode::GT:
+    case OpCode::ADD:
+    case OpCode::SUBTRACT:
+    case OpCode::MULTIPLY:
+    case OpCode::DIVIDE:
+    case OpCode::MODULO:
+    case OpCode::POWER:
+      Emit(opCode, 0, 0, 2);
+      return;
+    default:
+      throw std::runtime_error("Bytecode::EmitOperator: not an operator.");
+  }
+}
+
+// The stack only ever grows, so after the first few runs this is just a loop
+// over the code.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto Bytecode::Run(const ValueFrame& valueFrame) const -> std::span<const Value>
+{
+  thread_local auto t_stack = std::vector<Value>{};
+  if (t_stack.size() < m_maxDepth)
+  {
+    t_stack.resize(m_maxDepth);
+  }
+
+  auto* const bottom = t_stack.data();
+  auto* top          = bottom; // One past the top of stack
+
+  for (const auto& instruction : m_code)
+  {
+    switch (instruction.opCode)
+    {
+      case OpCode::PUSH_VALUE:
+        *top++ = m_values[static_cast<size_t>(instruction.operand)];
+        break;
+      case OpCode::PUSH_FORMAL:
+        *top++ = valueFrame.GetFormal(instruction.operand);
+        break;
+      case OpCode::PUSH_CONSTANT:
+        *top++ = valueFrame.GetConstant(instruction.operand);
+        break;
+      case OpCode::PUSH_NAME:
+        if (not valueFrame.GetSymbolTable().Lookup(Name{instruction.operand}.str(), *top))
+        {
+          std::cerr << "Fatal error in Bytecode::Run: no bound variable '"
+                    << Name{instruction.operand} << "'\n";
+          *top = Value{};
+        }
+        ++top;
+        break;
+      case OpCode::CALL:
+      {
+        top -= instruction.numArgs;
+        *top = m_functions[static_cast<size_t>(instruction.operand)](
+            std::span<const Value>{top, instruction.numArgs});
+        ++top;
+        break;
+      }
+      case OpCode::UNKNOWN_FUNCTION:
+        std::cerr << "Unimplemented function '" << Name{instruction.operand} << "'\n";
+        *top++ = Value{};
+        break;
+
+      case OpCode::NEGATE:
+        top[-1] = -top[-1];
+        break;
+      case OpCode::COMPLEMENT:
+        top[-1] = ~top[-1];
+        break;
+      case OpCode::NOT:
+        top[-1] = !top[-1];
+        break;
+
+      case OpCode::BITWISE_AND:
+        --top;
+        top[-1] = top[-1] & *top;
+        break;
+      case OpCode::BITWISE_OR:
+        --top;
+        top[-1] = top[-1] | *top;
+        break;
+      case OpCode::AND:
+        --top;
+        top[-1] = top[-1] && *top;
+        break;
+      case OpCode::OR:
+        --top;
+        top[-1] = top[-1] || *top;
+        break;
+      case OpCode::EQ:
+        --top;
+        top[-1] = top[-1] == *top;
+        break;
+      case OpCode::NE:
+        --top;
+        top[-1] = top[-1] != *top;
+        break;
+      case OpCode::LT:
+        --top;
+        top[-1] = top[-1] < *top;
+        break;
+      case OpCode::LE:
+        --top;
+        top[-1] = top[-1] <= *top;
+        break;
+      case OpCode::GE:
+        --top;
+        top[-1] = top[-1] >= *top;
+        break;
+      case OpCode::GT:
+        --top;
+        top[-1] = top[-1] > *top;
+        break;
+      case OpCode::ADD:
+        --top;
+        top[-1] = top[-1] + *top;
+        break;
+      case OpCode::SUBTRACT:
+        --top;
+        top[-1] = top[-1] - *top;
+        break;
+      case OpCode::MULTIPLY:
+        --top;
+        top[-1] = top[-1] * *top;
+        break;
+      case OpCode::DIVIDE:
+        --top;
+        top[-1] = top[-1] / *top;
+        break;
+      case OpCode::MODULO:
+        --top;
+        top[-1] = top[-1] % *top;
+        break;
+      case OpCode::POWER:
+        --top;
+        top[-1] = top[-1] ^ *top;
+        break;
+    }
+  }
+
+  assert(static_cast<size_t>(top - bottom) == m_numResults);
+  return std::span<const Value>{bottom, top};
+}
+
+} // namespace LSYS
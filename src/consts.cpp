@@ -13,9 +13,10 @@ auto Round(const float val, const int numDecimalPlaces) -> float
 {
   assert(numDecimalPlaces >= 0);
 
-  static constexpr auto TEN          = 10.0F;
-  static auto s_lastNumDecimalPlaces = 0;
-  static auto s_lastPowerOfTen       = 1.0;
+  static constexpr auto TEN = 10.0F;
+  // Per thread, so generators on different threads don't tear the cache.
+  thread_local auto s_lastNumDecimalPlaces = 0;
+  thread_local auto s_lastPowerOfTen       = 1.0;
   //    static double oneOnLastPowerOfTen= 1.0;
 
   if (numDecimalPlaces != s_lastNumDecimalPlaces)
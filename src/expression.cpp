@@ -40,10 +40,10 @@ module;
 
 #include <array>
 #include <cmath>
-#include <functional>
 #include <iostream>
 #include <memory>
 #include <ostream>
+#include <span>
 #include <stdexcept>
 #include <utility>
 
@@ -54,12 +54,15 @@ module;
 
 module LSys.Expression;
 
+import LSys.Bytecode;
 import LSys.Consts;
 import LSys.List;
+import LSys.ModelStream;
 import LSys.Name;
 import LSys.Rand;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 namespace LSYS
 {
@@ -67,75 +70,73 @@ namespace LSYS
 namespace
 {
 
-using ExprFunc =
-    std::function<Value(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)>;
+// Return the nth (0 base) argument in fltValue, if available.
+[[nodiscard]] auto GetFloatArg(const std::span<const Value> args,
+                               float& fltValue,
+                               const size_t n = 0) -> bool
+{
+  return (n < args.size()) and args[n].GetFloatValue(fltValue);
+}
 
-[[nodiscard]] auto ExprSin(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprSin(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(std::sin(MATHS::ToRadians(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprCos(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprCos(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(std::cos(MATHS::ToRadians(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprTan(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprTan(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(std::tan(MATHS::ToRadians(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprASin(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprASin(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(MATHS::ToDegrees(std::asin(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprACos(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprACos(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(MATHS::ToDegrees(std::acos(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprATan(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprATan(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(MATHS::ToDegrees(std::atan(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprATan2(const SymbolTable<Value>& symbolTable,
-                             List<Expression>& expressionList) -> Value
+[[nodiscard]] auto ExprATan2(const std::span<const Value> args) -> Value
 {
   auto x = 0.0F;
   auto y = 0.0F;
-  if (GetFloat(symbolTable, expressionList, y) and GetFloat(symbolTable, expressionList, x, 1))
+  if (GetFloatArg(args, y) and GetFloatArg(args, x, 1))
   {
     return Value(MATHS::ToDegrees(std::atan2(y, x)));
   }
@@ -143,21 +144,19 @@ using ExprFunc =
 }
 
 // Returns type of argument
-[[nodiscard]] auto ExprAbs(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprAbs(const std::span<const Value> args) -> Value
 {
-  if (auto v = Value{}; GetValue(symbolTable, expressionList, v))
+  if (args.empty())
   {
-    return v.Abs();
+    return Value{};
   }
-  return Value{};
+  return args[0].Abs();
 }
 
 // Always returns int
-[[nodiscard]] auto ExprCeil(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprCeil(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(static_cast<int>(std::ceil(x)));
   }
@@ -165,40 +164,36 @@ using ExprFunc =
 }
 
 // Always returns int
-[[nodiscard]] auto ExprFloor(const SymbolTable<Value>& symbolTable,
-                             List<Expression>& expressionList) -> Value
+[[nodiscard]] auto ExprFloor(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(static_cast<int>(std::floor(x)));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprExp(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprExp(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(std::exp(x));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprLog(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprLog(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(std::log(x));
   }
   return Value{};
 }
 
-[[nodiscard]] auto ExprLog10(const SymbolTable<Value>& symbolTable,
-                             List<Expression>& expressionList) -> Value
+[[nodiscard]] auto ExprLog10(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(std::log10(x));
   }
@@ -208,10 +203,9 @@ using ExprFunc =
 // Return a uniformly distributed random number;
 //  rand()  returns [0,1)
 //  rand(n) returns [0,n)   (floating point)
-[[nodiscard]] auto ExprRand(const SymbolTable<Value>& symbolTable, List<Expression>& expressionList)
-    -> Value
+[[nodiscard]] auto ExprRand(const std::span<const Value> args) -> Value
 {
-  if (auto x = 0.0F; GetFloat(symbolTable, expressionList, x))
+  if (auto x = 0.0F; GetFloatArg(args, x))
   {
     return Value(static_cast<double>(x) * GetRandDoubleInUnitInterval());
   }
@@ -219,9 +213,9 @@ using ExprFunc =
 }
 
 // The function table for function terms in expressions.
-auto GetFunctionSymbolTable() -> SymbolTable<ExprFunc>
+auto GetFunctionSymbolTable() -> SymbolTable<BuiltinFunc>
 {
-  auto symbolTable = SymbolTable<ExprFunc>{};
+  auto symbolTable = SymbolTable<BuiltinFunc>{};
 
   symbolTable.Enter("sin", ExprSin);
   symbolTable.Enter("cos", ExprCos);
@@ -244,6 +238,18 @@ auto GetFunctionSymbolTable() -> SymbolTable<ExprFunc>
 // NOLINTNEXTLINE(cert-err58-cpp)
 const auto FUNCTION_SYMBOL_TABLE = GetFunctionSymbolTable();
 
+// The builtin called by a function node, or nullptr if there is none.
+[[nodiscard]] auto FindBuiltin(const Name& name) -> BuiltinFunc
+{
+  auto func = BuiltinFunc{nullptr};
+  static_cast<void>(FUNCTION_SYMBOL_TABLE.Lookup(name.str(), func));
+  return func;
+}
+
+// No builtin takes more arguments than this; any extra arguments are still
+// evaluated, but not passed.
+constexpr auto MAX_BUILTIN_ARGS = 4U;
+
 [[nodiscard]] auto GetOpName(const int operation) -> const char*
 {
   switch (operation)
@@ -267,8 +273,9 @@ const auto FUNCTION_SYMBOL_TABLE = GetFunctionSymbolTable();
     case LSYS_GE:
       return ">=";
     default:
-      static auto s_str = std::array{' '};
-      s_str[0]          = static_cast<char>(operation);
+      // Per thread, as expressions may be printed while models load concurrently.
+      static thread_local auto s_str = std::array{' ', '\0'};
+      s_str[0]                       = static_cast<char>(operation);
       return s_str.data();
   }
 }
@@ -385,7 +392,8 @@ Expression::Expression(const Name& name, List<Expression>* funcArgs)
   : m_operation{funcArgs == nullptr ? LSYS_NAME : LSYS_FUNCTION},
     m_expressionValue{
         .name={.id=name.id(), .funcArgs={funcArgs == nullptr ? nullptr :
-             std::unique_ptr<List<Expression>>{funcArgs}}},
+             std::unique_ptr<List<Expression>>{funcArgs}},
+               .func=(funcArgs == nullptr) ? nullptr : FindBuiltin(name)},
         .value={},
         .args={},
     }
@@ -406,7 +414,8 @@ Expression::Expression(const Name& name, List<Expression>* funcArgs)
 // Create a function call node.
 Expression::Expression(const Name& name, std::unique_ptr<List<Expression>> funcArgs)
   : m_operation{LSYS_FUNCTION},
-    m_expressionValue{      .name={.id=name.id(), .funcArgs=std::move(funcArgs)},
+    m_expressionValue{      .name={.id=name.id(), .funcArgs=std::move(funcArgs),
+                                   .func=FindBuiltin(name)},
         .value={},
         .args={},
     }
@@ -429,10 +438,17 @@ Expression::Expression(const Value& value)
          std::cerr << "Creating expression w/op " << LSYS_VALUE << " GetValue " << value << "\n");
 }
 
-Expression::Expression(const Expression& other) : m_operation{other.m_operation},
+Expression::Expression(const Expression& other)
+  : m_operation{other.m_operation},
     m_expressionValue{
-  .name={.id=other.m_expressionValue.name.id, .funcArgs=nullptr}, .value=other.m_expressionValue.value,
-        .args=GetArgs(other.m_expressionValue.args)}
+        .name  = {.id           = other.m_expressionValue.name.id,
+                  .funcArgs     = nullptr,
+                  .func         = other.m_expressionValue.name.func,
+                  .formalSlot   = other.m_expressionValue.name.formalSlot,
+                  .constantSlot = other.m_expressionValue.name.constantSlot},
+        .value = other.m_expressionValue.value,
+        .args  = GetArgs(other.m_expressionValue.args),
+    }
 {
   if (m_operation == LSYS_FUNCTION)
   {
@@ -459,7 +475,213 @@ auto Expression::GetName() const -> Name
   return (m_operation == LSYS_NAME) ? GetVarName() : s_BOGUS;
 }
 
-auto Expression::Evaluate(const SymbolTable<Value>& symbolTable) const -> Value
+auto Expression::Write(ModelWriter& writer) const -> void
+{
+  writer.WriteInt(m_operation);
+  switch (m_operation)
+  {
+    case LSYS_VALUE:
+      writer.WriteValue(GetValue());
+      break;
+    case LSYS_NAME:
+      writer.WriteName(GetVarName());
+      break;
+    case LSYS_FUNCTION:
+      writer.WriteName(GetFuncName());
+      WriteList(writer, GetFuncArgs());
+      break;
+    default:
+      for (const auto& arg : m_expressionValue.args)
+      {
+        writer.WriteBool(arg != nullptr);
+        if (arg != nullptr)
+        {
+          arg->Write(writer);
+        }
+      }
+      break;
+  }
+}
+
+auto Expression::Read(ModelReader& reader) -> std::unique_ptr<Expression>
+{
+  const auto operation = reader.ReadInt();
+  switch (operation)
+  {
+    case LSYS_VALUE:
+      return std::make_unique<Expression>(reader.ReadValue());
+    case LSYS_NAME:
+      return std::make_unique<Expression>(reader.ReadName());
+    case LSYS_FUNCTION:
+    {
+      const auto name = reader.ReadName();
+      auto funcArgs   = ReadList<Expression>(reader);
+      if (funcArgs == nullptr)
+      {
+        throw std::runtime_error("Expression::Read: function without arguments.");
+      }
+      return std::make_unique<Expression>(name, std::move(funcArgs));
+    }
+    default:
+    {
+      auto lop = reader.ReadBool() ? Read(reader) : nullptr;
+      auto rop = reader.ReadBool() ? Read(reader) : nullptr;
+      return std::make_unique<Expression>(operation, lop.release(), rop.release());
+    }
+  }
+}
+
+// A name is a formal parameter if the production binds it, otherwise a
+// global value if one is defined. Names that are neither are left to be
+// looked up when evaluated.
+auto Expression::ResolveNames(const NameSlots& formalSlots,
+                              ConstantFrame& constants,
+                              const SymbolTable<Value>& symbolTable) -> void
+{
+  switch (m_operation)
+  {
+    case LSYS_VALUE:
+      break;
+
+    case LSYS_FUNCTION:
+      LSYS::ResolveNames(GetFuncArgs(), formalSlots, constants, symbolTable);
+      break;
+
+    case LSYS_NAME:
+      m_expressionValue.name.formalSlot   = formalSlots.Find(GetVarName());
+      m_expressionValue.name.constantSlot = (m_expressionValue.name.formalSlot != NO_SLOT)
+                                                ? NO_SLOT
+                                                : constants.GetSlot(GetVarName(), symbolTable);
+      break;
+
+    default:
+      for (auto& arg : m_expressionValue.args)
+      {
+        if (arg != nullptr)
+        {
+          arg->ResolveNames(formalSlots, constants, symbolTable);
+        }
+      }
+      break;
+  }
+}
+
+// Operands are emitted before their operator, left to right, so the code
+// evaluates in the same order as Evaluate.
+auto Expression::Compile(Bytecode& code) const -> void
+{
+  switch (m_operation)
+  {
+    case LSYS_VALUE:
+      code.EmitValue(GetValue());
+      return;
+
+    case LSYS_FUNCTION:
+      if (const auto func = m_expressionValue.name.func; func != nullptr)
+      {
+        auto argsIter = ConstListIterator<Expression>{*GetFuncArgs()};
+        for (const auto* arg = argsIter.first(); arg != nullptr; arg = argsIter.next())
+        {
+          arg->Compile(code);
+        }
+        code.EmitCall(func, GetFuncArgs()->size());
+        return;
+      }
+      code.EmitUnknownFunction(GetFuncName());
+      return;
+
+    case LSYS_NAME:
+      if (m_expressionValue.name.formalSlot != NO_SLOT)
+      {
+        code.EmitFormal(m_expressionValue.name.formalSlot);
+      }
+      else if (m_expressionValue.name.constantSlot != NO_SLOT)
+      {
+        code.EmitConstant(m_expressionValue.name.constantSlot);
+      }
+      else
+      {
+        code.EmitName(GetVarName());
+      }
+      return;
+
+    default:
+      break;
+  }
+
+  GetLChild()->Compile(code);
+  if (GetRChild() != nullptr)
+  {
+    GetRChild()->Compile(code);
+  }
+
+  switch (m_operation)
+  {
+    case LSYS_UMINUS:
+      code.EmitOperator(OpCode::NEGATE);
+      return;
+    case '~':
+      code.EmitOperator(OpCode::COMPLEMENT);
+      return;
+    case '!':
+      code.EmitOperator(OpCode::NOT);
+      return;
+    case '&':
+      code.EmitOperator(OpCode::BITWISE_AND);
+      return;
+    case '|':
+      code.EmitOperator(OpCode::BITWISE_OR);
+      return;
+    case LSYS_AND:
+      code.EmitOperator(OpCode::AND);
+      return;
+    case LSYS_OR:
+      code.EmitOperator(OpCode::OR);
+      return;
+    case LSYS_EQ:
+      code.EmitOperator(OpCode::EQ);
+      return;
+    case LSYS_NE:
+      code.EmitOperator(OpCode::NE);
+      return;
+    case '<':
+      code.EmitOperator(OpCode::LT);
+      return;
+    case LSYS_LE:
+      code.EmitOperator(OpCode::LE);
+      return;
+    case LSYS_GE:
+      code.EmitOperator(OpCode::GE);
+      return;
+    case '>':
+      code.EmitOperator(OpCode::GT);
+      return;
+    case '+':
+      code.EmitOperator(OpCode::ADD);
+      return;
+    case '-':
+      code.EmitOperator(OpCode::SUBTRACT);
+      return;
+    case '*':
+      code.EmitOperator(OpCode::MULTIPLY);
+      return;
+    case '/':
+      code.EmitOperator(OpCode::DIVIDE);
+      return;
+    case '%':
+      code.EmitOperator(OpCode::MODULO);
+      return;
+    case '^':
+      code.EmitOperator(OpCode::POWER);
+      return;
+    default:
+      std::cerr << "Fatal error in Expression::Compile: unrecognized operator '"
+                << static_cast<char>(m_operation) << "'= " << m_operation << "\n";
+      throw std::runtime_error("Fatal error in Expression::Compile: unrecognized operator.");
+  }
+}
+
+auto Expression::Evaluate(const ValueFrame& valueFrame) const -> Value
 {
   switch (m_operation)
   {
@@ -467,15 +689,35 @@ auto Expression::Evaluate(const SymbolTable<Value>& symbolTable) const -> Value
       return GetValue();
 
     case LSYS_FUNCTION:
-      if (ExprFunc exprFunc; FUNCTION_SYMBOL_TABLE.Lookup(GetFuncName().str(), exprFunc))
+      if (const auto func = m_expressionValue.name.func; func != nullptr)
       {
-        return exprFunc(symbolTable, *GetFuncArgs());
+        auto args     = std::array<Value, MAX_BUILTIN_ARGS>{};
+        auto numArgs  = 0U;
+        auto argsIter = ConstListIterator<Expression>{*GetFuncArgs()};
+        for (const auto* arg = argsIter.first(); arg != nullptr; arg = argsIter.next())
+        {
+          const auto value = arg->Evaluate(valueFrame);
+          if (numArgs < MAX_BUILTIN_ARGS)
+          {
+            args.at(numArgs) = value;
+            ++numArgs;
+          }
+        }
+        return func(std::span<const Value>{args}.first(numArgs));
       }
       std::cerr << "Unimplemented function '" << GetFuncName() << "'\n";
       return Value{};
 
     case LSYS_NAME:
-      if (Value value; symbolTable.Lookup(GetVarName().str(), value))
+      if (m_expressionValue.name.formalSlot != NO_SLOT)
+      {
+        return valueFrame.GetFormal(m_expressionValue.name.formalSlot);
+      }
+      if (m_expressionValue.name.constantSlot != NO_SLOT)
+      {
+        return valueFrame.GetConstant(m_expressionValue.name.constantSlot);
+      }
+      if (Value value; valueFrame.GetSymbolTable().Lookup(GetVarName().str(), value))
       {
         return value;
       }
@@ -487,59 +729,59 @@ auto Expression::Evaluate(const SymbolTable<Value>& symbolTable) const -> Value
 
     // Arithmetic
     case LSYS_UMINUS:
-      return -LEval(symbolTable);
+      return -LEval(valueFrame);
 
     // Bitwise complement
     case '~':
-      return ~LEval(symbolTable);
+      return ~LEval(valueFrame);
 
     // Logical complement
     case '!':
-      return !LEval(symbolTable);
+      return !LEval(valueFrame);
 
     // Binary operators
 
     // Bitwise logical and, or
     case '&':
-      return LEval(symbolTable) & REval(symbolTable);
+      return LEval(valueFrame) & REval(valueFrame);
     case '|':
-      return LEval(symbolTable) | REval(symbolTable);
+      return LEval(valueFrame) | REval(valueFrame);
 
     // Logical and, or
     case LSYS_AND:
-      return LEval(symbolTable) && REval(symbolTable);
+      return LEval(valueFrame) && REval(valueFrame);
     case LSYS_OR:
-      return LEval(symbolTable) || REval(symbolTable);
+      return LEval(valueFrame) || REval(valueFrame);
 
     // Logical comparisons
     case LSYS_EQ:
-      return LEval(symbolTable) == REval(symbolTable);
+      return LEval(valueFrame) == REval(valueFrame);
     case LSYS_NE:
-      return LEval(symbolTable) != REval(symbolTable);
+      return LEval(valueFrame) != REval(valueFrame);
     case '<':
-      return LEval(symbolTable) < REval(symbolTable);
+      return LEval(valueFrame) < REval(valueFrame);
     case LSYS_LE:
-      return LEval(symbolTable) <= REval(symbolTable);
+      return LEval(valueFrame) <= REval(valueFrame);
     case LSYS_GE:
-      return LEval(symbolTable) >= REval(symbolTable);
+      return LEval(valueFrame) >= REval(valueFrame);
     case '>':
-      return LEval(symbolTable) > REval(symbolTable);
+      return LEval(valueFrame) > REval(valueFrame);
 
     // Arithmetic
     case '+':
-      return LEval(symbolTable) + REval(symbolTable);
+      return LEval(valueFrame) + REval(valueFrame);
     case '-':
-      return LEval(symbolTable) - REval(symbolTable);
+      return LEval(valueFrame) - REval(valueFrame);
     case '*':
-      return LEval(symbolTable) * REval(symbolTable);
+      return LEval(valueFrame) * REval(valueFrame);
     case '/':
-      return LEval(symbolTable) / REval(symbolTable);
+      return LEval(valueFrame) / REval(valueFrame);
     // Modulo
     case '%':
-      return LEval(symbolTable) % REval(symbolTable);
+      return LEval(valueFrame) % REval(valueFrame);
     // Power, *not* XOR as in C
     case '^':
-      return LEval(symbolTable) ^ REval(symbolTable);
+      return LEval(valueFrame) ^ REval(valueFrame);
 
     // Shouldn't get here
     default:
@@ -549,53 +791,90 @@ auto Expression::Evaluate(const SymbolTable<Value>& symbolTable) const -> Value
   }
 }
 
-// Bind symbolic names of the list to values in list 'values'
-// using the symbol table for evaluation and binding. The two
-// lists should conform() for this method to succeed.
+// Bind the formals of the list to a span of bound values, such as the
+// parameters of a module in a module string, by setting their slots of
+// the value frame.
 // Returns true on success, false otherwise.
-// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
 auto Bind(const List<Expression>* const formals,
-          const List<Expression>* const values,
-          SymbolTable<Value>& symbolTable) -> bool
+          const std::span<const Value> values,
+          ValueFrame& valueFrame) -> bool
 {
-  // No binding need be done if one list is NULL
-  if ((nullptr == formals) or (nullptr == values))
+  if (nullptr == formals)
   {
     return true;
   }
 
-  if (not Conforms(formals, values))
+  if (formals->size() != values.size())
   {
     std::cerr << "Bind: formal and GetValue lists are not the same length\n";
     return false;
   }
 
-  auto left  = ConstListIterator<Expression>{*formals};
-  auto right = ConstListIterator<Expression>{*values};
-  const Expression* leftPtr{};
-  const Expression* rightPtr{};
-
-  for (leftPtr = left.first(), rightPtr = right.first();
-       (leftPtr != nullptr) and (rightPtr != nullptr);
-       leftPtr = left.next(), rightPtr = right.next())
+  auto left     = ConstListIterator<Expression>{*formals};
+  auto valuePtr = values.begin();
+  for (const auto* leftPtr = left.first(); leftPtr != nullptr; leftPtr = left.next(), ++valuePtr)
   {
-    if (leftPtr->GetType() != LSYS_NAME)
+    if ((leftPtr->GetType() != LSYS_NAME) or (leftPtr->GetFormalSlot() == NO_SLOT))
     {
       std::cerr << "Bind: left expression " << *leftPtr << " is not a formal\n";
       return false;
     }
-    if (rightPtr->GetType() != LSYS_VALUE)
+
+    PDebug(PD_EXPRESSION,
+           std::cerr << "Binding " << leftPtr->GetName() << "= " << *valuePtr << "\n");
+    valueFrame.SetFormal(leftPtr->GetFormalSlot(), *valuePtr);
+  }
+
+  return true;
+}
+
+auto AddFormalSlots(const List<Expression>* const formals, NameSlots& formalSlots) -> void
+{
+  if (nullptr == formals)
+  {
+    return;
+  }
+
+  auto exprIter = ConstListIterator<Expression>{*formals};
+  for (const auto* expr = exprIter.first(); expr != nullptr; expr = exprIter.next())
+  {
+    if (expr->GetType() == LSYS_NAME)
     {
-      std::cerr << "Bind: right expression " << *rightPtr << " is not a value\n";
-      return false;
+      formalSlots.Add(expr->GetName());
     }
+  }
+}
 
-    const Value value = rightPtr->Evaluate(symbolTable);
-    PDebug(PD_EXPRESSION, std::cerr << "Binding " << leftPtr->GetName() << "= " << value << "\n");
-    symbolTable.Enter(leftPtr->GetName().str(), value);
+auto Compile(const List<Expression>* const expressionList, Bytecode& code) -> void
+{
+  if (nullptr == expressionList)
+  {
+    return;
   }
 
-  return true;
+  auto exprIter = ConstListIterator<Expression>{*expressionList};
+  for (const auto* expr = exprIter.first(); expr != nullptr; expr = exprIter.next())
+  {
+    expr->Compile(code);
+    code.EndExpression();
+  }
+}
+
+auto ResolveNames(List<Expression>* const expressionList,
+                  const NameSlots& formalSlots,
+                  ConstantFrame& constants,
+                  const SymbolTable<Value>& symbolTable) -> void
+{
+  if (nullptr == expressionList)
+  {
+    return;
+  }
+
+  auto exprIter = ListIterator<Expression>{*expressionList};
+  for (auto* expr = exprIter.first(); expr != nullptr; expr = exprIter.next())
+  {
+    expr->ResolveNames(formalSlots, constants, symbolTable);
+  }
 }
 
 // Check if list 'el' is conformant with the list, e.g.,
@@ -612,7 +891,7 @@ auto Conforms(const List<Expression>* const formals, const List<Expression>* con
 // expressions evaluated in the context of the symbol table.
 // Return a NULL expression list if a NULL list is passed
 auto Instantiate(const List<Expression>* const before,
-                 const SymbolTable<Value>& symbolTable) noexcept
+                 const ValueFrame& valueFrame) noexcept
     -> std::unique_ptr<List<Expression>>
 {
   if (nullptr == before)
@@ -625,7 +904,7 @@ auto Instantiate(const List<Expression>* const before,
 
   for (const auto* expr = exprIter.first(); expr != nullptr; expr = exprIter.next())
   {
-    auto newExpr = std::make_unique<Expression>(expr->Evaluate(symbolTable));
+    auto newExpr = std::make_unique<Expression>(expr->Evaluate(valueFrame));
     newExprList->append(std::move(newExpr));
   }
 
@@ -640,7 +919,7 @@ auto Instantiate(const List<Expression>* const before,
 // This should be wrapped around a method of class List(Expression),
 // but that's a pain with the template method used.
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-auto GetValue(const SymbolTable<Value>& symbolTable,
+auto GetValue(const ValueFrame& valueFrame,
               const List<Expression>& expressionList,
               Value& value,
               const unsigned int n) -> bool
@@ -668,18 +947,18 @@ auto GetValue(const SymbolTable<Value>& symbolTable,
 
   // Evaluate the expression. Since all expressions should have reduced
   //   to bound values by now, an empty symbol table is used.
-  value = expr->Evaluate(symbolTable);
+  value = expr->Evaluate(valueFrame);
 
   return true;
 }
 
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-auto GetFloat(const SymbolTable<Value>& symbolTable,
+auto GetFloat(const ValueFrame& valueFrame,
               const List<Expression>& expressionList,
               float& fltValue,
               const unsigned int n) -> bool
 {
-  if (Value value; GetValue(symbolTable, expressionList, value, n))
+  if (Value value; GetValue(valueFrame, expressionList, value, n))
   {
     return value.GetFloatValue(fltValue);
   }
@@ -30,7 +30,10 @@
 module;
 
 #include <cassert>
+#include <memory>
 #include <stdexcept>
+#include <streambuf>
+#include <string_view>
 
 module LSys.Generator;
 
@@ -64,4 +67,23 @@ auto IGenerator::LineTo() -> void
   m_lastMove     = false;
 }
 
+auto IGenerator::MakeChunkGenerator([[maybe_unused]] std::streambuf* const output) const
+    -> std::unique_ptr<IGenerator>
+{
+  return nullptr;
+}
+
+auto IGenerator::AppendChunkOutput([[maybe_unused]] const std::string_view chunkOutput) -> void
+{
+  throw std::runtime_error("This generator can't interpret in parallel.");
+}
+
+auto IGenerator::GetNumObjects() const -> int
+{
+  return 0;
+}
+
+auto IGenerator::SetNumObjects([[maybe_unused]] const int numObjects) -> void
+{}
+
 } // namespace LSYS
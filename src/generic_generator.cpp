@@ -3,11 +3,15 @@ module;
 #include <cstdint>
 #include <fstream>
 #include <iomanip>
+#include <ios>
+#include <memory>
 #include <stdexcept>
+#include <streambuf>
+#include <string_view>
 
 module LSys.GenericGenerator;
 
-import LSys.Module;
+import LSys.Name;
 import LSys.Turtle;
 import LSys.Vector;
 
@@ -20,9 +24,11 @@ static constexpr auto* INDENT   = "  ";
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
 GenericGenerator::GenericGenerator(const std::string& outputFilename,
                                    const std::string& boundsFilename)
-  : m_output{outputFilename}, m_boundsOutput{boundsFilename}
+  : m_outputFile{outputFilename},
+    m_boundsOutput{boundsFilename},
+    m_output{m_outputFile.rdbuf()}
 {
-  if (not m_output)
+  if (not m_outputFile)
   {
     throw std::runtime_error("RadianceGenerator: Could not open output file.");
   }
@@ -32,6 +38,25 @@ GenericGenerator::GenericGenerator(const std::string& outputFilename,
   }
 }
 
+// A stream with no buffer is bad, so it skips formatting anything written to it.
+GenericGenerator::GenericGenerator(const GenericGenerator& generator, std::streambuf* const output)
+  : IGenerator{generator}, m_output{output}, m_groupNum{generator.m_groupNum}
+{
+  m_output.copyfmt(generator.m_output);
+}
+
+auto GenericGenerator::MakeChunkGenerator(std::streambuf* const output) const
+    -> std::unique_ptr<IGenerator>
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-owning-memory): the constructor is private
+  return std::unique_ptr<IGenerator>{new GenericGenerator{*this, output}};
+}
+
+auto GenericGenerator::AppendChunkOutput(const std::string_view chunkOutput) -> void
+{
+  m_output.write(chunkOutput.data(), static_cast<std::streamsize>(chunkOutput.size()));
+}
+
 auto GenericGenerator::SetHeader(const std::string& header) -> void
 {
   IGenerator::SetHeader(header);
@@ -63,7 +88,7 @@ auto GenericGenerator::Postscript() -> void
   {
     OutputFailed();
   }
-  m_output.close();
+  m_outputFile.close();
 }
 
 auto GenericGenerator::StartGraphics() -> void
@@ -185,10 +210,10 @@ auto GenericGenerator::LineTo() -> void
   IGenerator::LineTo();
 }
 
-auto GenericGenerator::DrawObject(const Module& mod, const int numArgs, const ArgsArray& args)
+auto GenericGenerator::DrawObject(const Name& name, const int numArgs, const ArgsArray& args)
     -> void
 {
-  const auto objName      = mod.GetName().str().erase(0, 1); // skip '~'
+  const auto objName      = name.str().substr(1); // skip '~'
   const auto contactPoint = GetLastPosition();
 
   ++m_groupNum;
@@ -4,7 +4,7 @@ module;
 
 module LSys.GraphicsGenerator;
 
-import LSys.Module;
+import LSys.Name;
 import LSys.Vector;
 
 namespace LSYS
@@ -70,7 +70,7 @@ auto GraphicsGenerator::LineTo() -> void
   IGenerator::LineTo();
 }
 
-auto GraphicsGenerator::DrawObject([[maybe_unused]] const Module& mod,
+auto GraphicsGenerator::DrawObject([[maybe_unused]] const Name& name,
                                    [[maybe_unused]] const int numArgs,
                                    [[maybe_unused]] const ArgsArray& args) -> void
 {
@@ -29,9 +29,19 @@ module;
 
 #include "debug.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <numeric>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
-#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 module LSys.Interpret;
 
@@ -39,7 +49,8 @@ import LSys.Actions;
 import LSys.Consts;
 import LSys.Expression;
 import LSys.Generator;
-import LSys.Module;
+import LSys.ModuleString;
+import LSys.Name;
 import LSys.SymbolTable;
 import LSys.Turtle;
 import LSys.Vector;
@@ -47,6 +58,59 @@ import LSys.Vector;
 namespace LSYS
 {
 
+namespace
+{
+
+// Strings shorter than two chunks are interpreted serially.
+constexpr auto MIN_MODULES_PER_CHUNK = 1024U;
+// More chunks than threads, to even out chunks that generate more than others.
+constexpr auto CHUNKS_PER_THREAD = 4U;
+
+// True if any module of the string has one of the names. A flag per name id
+// makes the pass a load per module, without branches.
+template<size_t N>
+auto HasAnyName(const ModuleString& modules, const std::array<int, N>& nameIds) -> bool
+{
+  auto hasName = std::vector<uint8_t>(static_cast<size_t>(Name::GetNumNames()), 0);
+  for (const auto nameId : nameIds)
+  {
+    hasName[static_cast<size_t>(nameId)] = 1;
+  }
+
+  auto hasAnyName = uint8_t{0};
+  for (auto i = 0U; i < modules.size(); ++i)
+  {
+    hasAnyName |= hasName[static_cast<size_t>(modules.GetNameId(i))];
+  }
+  return hasAnyName != 0;
+}
+
+// Call func(i) for each i below count, on up to numThreads threads.
+template<typename Func>
+auto ForEachInParallel(const size_t count, const uint32_t numThreads, const Func& func) -> void
+{
+  auto next         = std::atomic<size_t>{0};
+  const auto worker = [&]()
+  {
+    for (auto i = next++; i < count; i = next++)
+    {
+      func(i);
+    }
+  };
+
+  auto workers = std::vector<std::future<void>>{};
+  for (auto i = 0U; i < std::min(static_cast<size_t>(numThreads), count); ++i)
+  {
+    workers.emplace_back(std::async(std::launch::async, worker));
+  }
+  for (auto& thread : workers)
+  {
+    thread.get();
+  }
+}
+
+} // namespace
+
 // NOLINTNEXTLINE(cert-err58-cpp)
 const SymbolTable<ActionFunc> Interpreter::ACTION_SYMBOL_TABLE = GetActionSymbolTable();
 
@@ -93,6 +157,45 @@ auto Interpreter::GetActionSymbolTable() -> SymbolTable<ActionFunc>
   return symbolTable;
 }
 
+// NOLINTNEXTLINE(cert-err58-cpp)
+const SymbolTable<ActionFunc> Interpreter::PLANAR_ACTION_SYMBOL_TABLE =
+    GetPlanarActionSymbolTable();
+
+// The default actions, with the motions replaced by their planar versions.
+auto Interpreter::GetPlanarActionSymbolTable() -> SymbolTable<ActionFunc>
+{
+  auto symbolTable = GetActionSymbolTable();
+
+  symbolTable.Enter("f", MoveInPlane);
+  symbolTable.Enter("z", MoveHalfInPlane);
+  symbolTable.Enter("F", DrawInPlane);
+  symbolTable.Enter("Fl", DrawInPlane);
+  symbolTable.Enter("Fr", DrawInPlane);
+  symbolTable.Enter("Z", DrawHalfInPlane);
+  symbolTable.Enter("+", TurnLeftInPlane);
+  symbolTable.Enter("-", TurnRightInPlane);
+  symbolTable.Enter("G", PolygonMoveInPlane);
+
+  return symbolTable;
+}
+
+// True if the string has a module whose action can turn the turtle out of
+// the XY plane: a pitch, a roll, $ or tropism. The other actions only turn
+// the turtle about its up vector, or reverse it.
+auto Interpreter::LeavesPlane(const ModuleString& modules) -> bool
+{
+  static const auto s_OUT_OF_PLANE_IDS = std::array{
+      Name{"&"}.id(),
+      Name{"^"}.id(),
+      Name{"\\"}.id(),
+      Name{"/"}.id(),
+      Name{"$"}.id(),
+      Name{"t"}.id(),
+  };
+
+  return HasAnyName(modules, s_OUT_OF_PLANE_IDS);
+}
+
 Interpreter::Interpreter(IGenerator& generator) : m_generator{&generator}
 {
   m_generator->SetTurtle(m_turtle);
@@ -112,42 +215,429 @@ auto Interpreter::SetDefaults(const DefaultParams& defaultParams) -> void
   m_turtle.SetGravity(Vector(0, 1, 0));
 }
 
-auto Interpreter::InterpretAllModules(const List<Module>& moduleList) -> void
+auto Interpreter::InterpretAllModules(const ModuleString& modules) -> void
+{
+  Start(modules);
+
+  if (const auto inParallel = (m_numThreads > 1) and
+                              (modules.size() >= (2 * MIN_MODULES_PER_CHUNK)) and
+                              InterpretAllModulesInParallel(modules);
+      not inParallel)
+  {
+    while (not AllDone())
+    {
+      InterpretNext();
+    }
+  }
+
+  Finish();
+}
+
+// Interpret the string in chunks on several threads; return false, having
+// done nothing, if the generator can't make chunk generators. The state at
+// the start of each chunk comes from a pass over the whole string that moves
+// the turtle but writes nothing, which costs a fraction of generating the
+// output, but is serial; if chunk composition is on and the string allows
+// it, the state is composed from the chunks' motions instead.
+auto Interpreter::InterpretAllModulesInParallel(const ModuleString& modules) -> bool
+{
+  const auto stateGenerator = m_generator->MakeChunkGenerator(nullptr);
+  if (stateGenerator == nullptr)
+  {
+    return false;
+  }
+
+  // Resolve all the actions now, so the threads only read the action table.
+  ResolveActions();
+  const auto composed = m_composeChunks and ComposesMotions(modules);
+  auto chunks         = composed ? GetComposedChunks(modules, *stateGenerator)
+                                 : GetChunks(modules, *stateGenerator);
+
+  ForEachInParallel(chunks.size(),
+                    m_numThreads,
+                    [&](const size_t chunk) { InterpretChunk(modules, chunks[chunk]); });
+
+  // Without the state pass, the turtle is left where the last chunk left it,
+  // with the bounds of every chunk's path.
+  if (composed)
+  {
+    auto turtle = chunks.back().turtle;
+    for (const auto& chunk : chunks)
+    {
+      turtle.ExpandBoundingBox(chunk.turtle.GetBoundingBox());
+    }
+    m_turtle        = turtle;
+    m_actionContext = chunks.back().actionContext;
+  }
+
+  for (const auto& chunk : chunks)
+  {
+    m_generator->AppendChunkOutput(chunk.output);
+  }
+  return true;
+}
+
+// True if the turtle's motion in a chunk can be worked out without knowing
+// the state at its start, and composed with it: the string moves and turns
+// the turtle, and pushes and pops its pose, but nothing else changes the
+// state. Tropism and $ depend on the turtle's absolute frame; the others
+// change attributes, widths, polygons or which modules are interpreted,
+// which a chunk would need the state before it to know.
+auto Interpreter::ComposesMotions(const ModuleString& modules) -> bool
+{
+  static const auto s_STATE_CHANGE_IDS = std::array{
+      Name{"t"}.id(),
+      Name{"$"}.id(),
+      Name{"%"}.id(),
+      Name{"!"}.id(),
+      Name{"@mw"}.id(),
+      Name{"@md"}.id(),
+      Name{"@ma"}.id(),
+      Name{"'"}.id(),
+      Name{"@Tx"}.id(),
+      Name{"{"}.id(),
+      Name{"."}.id(),
+      Name{"G"}.id(),
+      Name{"}"}.id(),
+  };
+
+  return not HasAnyName(modules, s_STATE_CHANGE_IDS);
+}
+
+// Split the string into chunks, each starting right after a draw, so the
+// drawing state at its start is known: the generator drew a line to the
+// turtle's position, and the attributes last sent to it are the turtle's,
+// once a pop has sent them. The chunks' motions are worked out concurrently,
+// then composed in order to find the poses each chunk starts from. A chunk
+// whose drawing state was not as expected is moved again, from the state
+// the chunk before it left.
+auto Interpreter::GetComposedChunks(const ModuleString& modules, const IGenerator& stateGenerator)
+    -> std::vector<Chunk>
+{
+  auto motions = GetChunkMotions(modules);
+  ForEachInParallel(motions.size(),
+                    m_numThreads,
+                    [&](const size_t chunk)
+                    { MoveChunk(modules, stateGenerator, motions[chunk]); });
+
+  auto poses = m_turtle.GetPoseStack();
+  poses.push_back(m_turtle.GetCurrentState());
+  auto numObjects = stateGenerator.GetNumObjects();
+
+  auto chunks = std::vector<Chunk>{};
+  chunks.reserve(motions.size());
+  for (auto i = 0U; i < motions.size(); ++i)
+  {
+    auto& motion = motions[i];
+    if ((i > 0) and (motion.startContext != motions[i - 1].endContext))
+    {
+      motion.startContext = motions[i - 1].endContext;
+      MoveChunk(modules, stateGenerator, motion);
+    }
+
+    chunks.push_back({.begin         = motion.begin,
+                      .end           = motion.end,
+                      .turtle        = m_turtle,
+                      .actionContext = motion.startContext,
+                      .generator     = stateGenerator.MakeChunkGenerator(nullptr),
+                      .output        = {}});
+    auto& chunk = chunks.back();
+    chunk.turtle.SetPose(poses.back(), {poses.begin(), std::prev(poses.end())});
+    if (i > 0)
+    {
+      // The draw that ends the chunk before, without its output.
+      chunk.generator->SetTurtle(chunk.turtle);
+      chunk.generator->IGenerator::LineTo();
+      chunk.generator->SetNumObjects(numObjects);
+    }
+
+    const auto& relativePoses = motion.turtle.GetPoseStack();
+    auto endPoses             = std::vector<Turtle::Pose>{};
+    endPoses.reserve(relativePoses.size() + 1);
+    for (auto depth = 0U; depth < relativePoses.size(); ++depth)
+    {
+      endPoses.push_back(
+          (depth < motion.minDepth)
+              ? poses[depth]
+              : Turtle::ComposePoses(poses[motion.bases[depth]], relativePoses[depth]));
+    }
+    endPoses.push_back(
+        Turtle::ComposePoses(poses[motion.base], motion.turtle.GetCurrentState()));
+    poses = std::move(endPoses);
+    numObjects += motion.numObjects;
+  }
+
+  return chunks;
+}
+
+// The chunks start at the first draw at or after their nominal start. The
+// stack depth and the drawing state expected at each start come from the
+// brackets before it.
+auto Interpreter::GetChunkMotions(const ModuleString& modules) const -> std::vector<ChunkMotion>
+{
+  static const auto s_DRAW_IDS = std::array{
+      Name{"F"}.id(),
+      Name{"Fl"}.id(),
+      Name{"Fr"}.id(),
+      Name{"Z"}.id(),
+  };
+  static const auto s_LEFT_BRACKET_ID  = Name{"["}.id();
+  static const auto s_RIGHT_BRACKET_ID = Name{"]"}.id();
+
+  const auto numChunks = std::min(static_cast<size_t>(m_numThreads) * CHUNKS_PER_THREAD,
+                                  modules.size() / MIN_MODULES_PER_CHUNK);
+  const auto chunkSize = (modules.size() + numChunks - 1) / numChunks;
+
+  auto motions = std::vector<ChunkMotion>{};
+  motions.reserve(numChunks);
+  motions.push_back({.begin        = 0,
+                     .end          = modules.size(),
+                     .startDepth   = m_turtle.GetPoseStack().size(),
+                     .startContext = m_actionContext});
+
+  // Once a pop not followed by another has sent the turtle's width and
+  // color, the generator has them.
+  auto drawnContext   = ActionContext{.state = ActionContext::State::DRAWING};
+  auto depth          = m_turtle.GetPoseStack().size();
+  auto nextChunkBegin = chunkSize;
+  for (auto i = 0U; i < modules.size(); ++i)
+  {
+    if ((i >= nextChunkBegin) and
+        (std::ranges::find(s_DRAW_IDS, modules.GetNameId(i - 1)) != s_DRAW_IDS.end()))
+    {
+      motions.back().end = i;
+      motions.push_back(
+          {.begin = i, .end = modules.size(), .startDepth = depth, .startContext = drawnContext});
+      nextChunkBegin = i + chunkSize;
+    }
+
+    if (const auto nameId = modules.GetNameId(i); nameId == s_LEFT_BRACKET_ID)
+    {
+      ++depth;
+    }
+    else if ((nameId == s_RIGHT_BRACKET_ID) and (depth > 0))
+    {
+      --depth;
+      if (((i + 1) < modules.size()) and (modules.GetNameId(i + 1) != s_RIGHT_BRACKET_ID))
+      {
+        drawnContext.lastLineWidth = m_turtle.GetCurrentState().width;
+        drawnContext.lastColor     = m_turtle.GetCurrentState().color;
+      }
+    }
+  }
+
+  return motions;
+}
+
+// Interpret a chunk with a generator that writes nothing, and a turtle that
+// starts from identity poses. A push records the start pose the pushed pose
+// is relative to, and a pop restores it.
+auto Interpreter::MoveChunk(const ModuleString& modules,
+                            const IGenerator& stateGenerator,
+                            ChunkMotion& motion) -> void
+{
+  auto identity = Turtle::Pose{.width = m_turtle.GetCurrentState().width};
+  identity.frame.Identity();
+
+  motion.turtle = m_turtle;
+  motion.turtle.SetPose(identity, std::vector<Turtle::Pose>(motion.startDepth, identity));
+  motion.base = motion.startDepth;
+  motion.bases.resize(motion.startDepth);
+  std::iota(motion.bases.begin(), motion.bases.end(), size_t{0});
+  motion.minDepth   = motion.startDepth;
+  motion.endContext = motion.startContext;
+
+  const auto generator = stateGenerator.MakeChunkGenerator(nullptr);
+  generator->SetTurtle(motion.turtle);
+
+  auto moduleIter = ModuleStringIterator{modules};
+  for (moduleIter.SetPos(motion.begin); moduleIter.GetPos() < motion.end; moduleIter.next())
+  {
+    const auto depth = motion.turtle.GetPoseStack().size();
+    InterpretModule(motion.endContext, moduleIter, motion.turtle, *generator);
+
+    if (const auto newDepth = motion.turtle.GetPoseStack().size(); newDepth > depth)
+    {
+      motion.bases.push_back(motion.base);
+    }
+    else if (newDepth < depth)
+    {
+      motion.base = motion.bases.back();
+      motion.bases.pop_back();
+      motion.minDepth = std::min(motion.minDepth, newDepth);
+    }
+  }
+
+  motion.numObjects = generator->GetNumObjects() - stateGenerator.GetNumObjects();
+}
+
+// The state pass: interpret the whole string with a generator that writes
+// nothing, recording the state at the start of each chunk. A chunk starts at
+// the first module interpreted at or after its nominal start, as % skips
+// modules. The turtle is left at the end of the string, with the bounds of
+// the whole path.
+auto Interpreter::GetChunks(const ModuleString& modules, IGenerator& stateGenerator)
+    -> std::vector<Chunk>
+{
+  const auto numChunks = std::min(static_cast<size_t>(m_numThreads) * CHUNKS_PER_THREAD,
+                                  modules.size() / MIN_MODULES_PER_CHUNK);
+  const auto chunkSize = (modules.size() + numChunks - 1) / numChunks;
+
+  stateGenerator.SetTurtle(m_turtle);
+  auto chunks = std::vector<Chunk>{};
+  chunks.reserve(numChunks);
+  auto nextChunkBegin = size_t{0};
+  for (auto moduleIter = ModuleStringIterator{modules}; not moduleIter.AtEnd(); moduleIter.next())
+  {
+    if (const auto pos = moduleIter.GetPos(); pos >= nextChunkBegin)
+    {
+      if (not chunks.empty())
+      {
+        chunks.back().end = pos;
+      }
+      chunks.push_back({.begin         = pos,
+                        .end           = modules.size(),
+                        .turtle        = m_turtle,
+                        .actionContext = m_actionContext,
+                        .generator     = stateGenerator.MakeChunkGenerator(nullptr),
+                        .output        = {}});
+      nextChunkBegin = pos + chunkSize;
+    }
+    InterpretModule(m_actionContext, moduleIter, m_turtle, stateGenerator);
+  }
+
+  return chunks;
+}
+
+auto Interpreter::InterpretChunk(const ModuleString& modules, Chunk& chunk) -> void
+{
+  auto output          = std::stringbuf{};
+  const auto generator = chunk.generator->MakeChunkGenerator(&output);
+  generator->SetTurtle(chunk.turtle);
+
+  auto moduleIter = ModuleStringIterator{modules};
+  for (moduleIter.SetPos(chunk.begin); moduleIter.GetPos() < chunk.end; moduleIter.next())
+  {
+    InterpretModule(chunk.actionContext, moduleIter, chunk.turtle, *generator);
+  }
+
+  chunk.output = std::move(output).str();
+}
+
+auto Interpreter::StartStream() -> void
+{
+  SetPlanar(m_turtle.IsPlanar());
+  m_generator->Prelude();
+  m_actionContext = ActionContext{};
+  m_streamModules.clear();
+  m_heldBackModule.clear();
+  m_pendingCut = ModuleStringIterator::NO_CUT;
+}
+
+auto Interpreter::InterpretStream(const ModuleString& modules) -> void
+{
+  m_streamModules.Append(m_heldBackModule);
+  m_heldBackModule.clear();
+
+  if (modules.empty())
+  {
+    return;
+  }
+
+  SetPlanar(m_planar and not LeavesPlane(modules));
+  const auto last = modules.size() - 1;
+  for (auto i = 0U; i < last; ++i)
+  {
+    m_streamModules.Append(modules, i);
+  }
+  if (modules.IsRightBracket(last))
+  {
+    m_heldBackModule.Append(modules, last);
+  }
+  else
+  {
+    m_streamModules.Append(modules, last);
+  }
+
+  InterpretStreamModules();
+}
+
+auto Interpreter::FinishStream() -> void
+{
+  m_streamModules.Append(m_heldBackModule);
+  m_heldBackModule.clear();
+  InterpretStreamModules();
+
+  Finish();
+}
+
+// Interpret the buffered piece of the stream, carrying a cut (%) that runs
+// off its end over to the next piece.
+auto Interpreter::InterpretStreamModules() -> void
 {
-  Start(moduleList);
+  m_moduleIter = std::make_unique<ModuleStringIterator>(m_streamModules);
+  m_moduleIter->ResumeCut(m_pendingCut);
 
   while (not AllDone())
   {
     InterpretNext();
   }
 
-  Finish();
+  m_pendingCut = m_moduleIter->GetPendingCut();
+  m_moduleIter = nullptr;
+  m_streamModules.clear();
+}
+
+// Look up the actions of all the names interned since the last call, with
+// every ~object name mapped to DrawObject.
+auto Interpreter::ResolveActions() -> void
+{
+  const auto& actionSymbolTable = m_planar ? PLANAR_ACTION_SYMBOL_TABLE : ACTION_SYMBOL_TABLE;
+  const auto numNames           = static_cast<size_t>(Name::GetNumNames());
+  for (auto nameId = m_actionsByNameId.size(); nameId < numNames; ++nameId)
+  {
+    auto actionFunc = ActionFunc{};
+    static_cast<void>(
+        actionSymbolTable.Lookup(GetModuleName(Name{static_cast<int>(nameId)}), actionFunc));
+    m_actionsByNameId.push_back(std::move(actionFunc));
+  }
 }
 
-auto Interpreter::InterpretNextModule(const Module& mod) -> bool
+auto Interpreter::InterpretNextModule() -> bool
 {
-  PDebug(PD_INTERPRET, std::cerr << "Interpreting module " << mod << "\n");
+  return InterpretModule(m_actionContext, *m_moduleIter, m_turtle, *m_generator);
+}
+
+auto Interpreter::InterpretModule(ActionContext& actionContext,
+                                  ModuleStringIterator& moduleIter,
+                                  Turtle& turtle,
+                                  IGenerator& generator) -> bool
+{
+  const auto& modules = moduleIter.GetModuleString();
+  const auto pos      = moduleIter.GetPos();
+
+  PDebug(PD_INTERPRET, std::cerr << "Interpreting module " << modules.ToString(pos) << "\n");
 
-  ActionFunc actionFunc;
-  if (not ACTION_SYMBOL_TABLE.Lookup(GetModuleName(mod), actionFunc))
+  const auto& actionFunc = GetAction(modules.GetNameId(pos));
+  if (not actionFunc)
   {
-    PDebug(PD_INTERPRET, std::cerr << "No action for module " << mod << "\n");
+    PDebug(PD_INTERPRET, std::cerr << "No action for module " << modules.ToString(pos) << "\n");
     return false;
     // TODO(glk) - Should this be a failed lookup?
     //throw std::runtime_error("Unknown action.");
   }
 
   // Fetch defined parameters
-  const auto [numArgs, args] = GetActionArgsArray(mod);
-  actionFunc(*m_moduleIter, m_turtle, *m_generator, numArgs, args);
-  PDebug(PD_INTERPRET, std::cerr << m_turtle);
+  const auto [numArgs, args] = GetActionArgsArray(modules, pos);
+  actionFunc(actionContext, moduleIter, turtle, generator, numArgs, args);
+  PDebug(PD_INTERPRET, std::cerr << turtle);
 
   return true;
 }
 
-inline auto Interpreter::GetModuleName(const Module& mod) -> std::string
+inline auto Interpreter::GetModuleName(const Name& name) -> std::string_view
 {
-  if (auto moduleName = mod.GetName().str(); moduleName[0] != DRAW_OBJECT_START_CHAR)
+  if (const auto moduleName = name.str(); not moduleName.starts_with(DRAW_OBJECT_START_CHAR))
   {
     return moduleName;
   }
@@ -155,14 +645,15 @@ inline auto Interpreter::GetModuleName(const Module& mod) -> std::string
   return DRAW_OBJECT_START;
 }
 
-inline auto Interpreter::GetActionArgsArray(const Module& mod) -> std::pair<int, ArgsArray>
+inline auto Interpreter::GetActionArgsArray(const ModuleString& modules, const size_t i)
+    -> std::pair<int, ArgsArray>
 {
   int numArgs = 0;
   ArgsArray args{};
 
-  for (auto i = 0U; i < MAX_ARGS; ++i)
+  for (auto n = 0U; n < MAX_ARGS; ++n)
   {
-    if (not mod.GetFloat(args.at(i), i))
+    if (not modules.GetFloat(i, args.at(n), n))
     {
       break;
     }
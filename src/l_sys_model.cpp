@@ -26,23 +26,107 @@ module;
 
 #include "debug.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 module LSys.LSysModel;
 
 import LSys.Expression;
 import LSys.List;
+import LSys.ModelStream;
 import LSys.Module;
+import LSys.ModuleString;
+import LSys.Name;
 import LSys.Production;
+import LSys.Rand;
+import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 namespace LSYS
 {
 
 LSysModel::~LSysModel() noexcept = default;
 
+namespace
+{
+
+auto WriteSymbolTable(ModelWriter& writer, const SymbolTable<Value>& symbolTable) -> void
+{
+  writer.WriteSize(symbolTable.size());
+  symbolTable.ForEach(
+      [&writer](const std::string_view name, const Value& value)
+      {
+        writer.WriteString(name);
+        writer.WriteValue(value);
+      });
+}
+
+auto ReadSymbolTable(ModelReader& reader, SymbolTable<Value>& symbolTable) -> void
+{
+  const auto numSymbols = reader.ReadSize();
+  for (auto i = 0U; i < numSymbols; ++i)
+  {
+    const auto name = reader.ReadString();
+    symbolTable.Enter(name, reader.ReadValue());
+  }
+}
+
+auto GetCutName() -> const Name&
+{
+  static const auto s_CUT = Name{"%"};
+  return s_CUT;
+}
+
+auto HasModule(const List<Module>& modules, const Name& name) -> bool
+{
+  auto moduleIter = ConstListIterator<Module>{modules};
+  for (const auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
+  {
+    if (module->GetName() == name)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+auto LSysModel::Write(ModelWriter& writer) const -> void
+{
+  WriteSymbolTable(writer, m_symbolTable);
+  WriteSymbolTable(writer, m_ignoreTable);
+  WriteList(writer, m_start.get());
+  WriteList(writer, m_rules.get());
+}
+
+auto LSysModel::Read(ModelReader& reader) -> std::unique_ptr<LSysModel>
+{
+  auto model = std::make_unique<LSysModel>();
+  ReadSymbolTable(reader, model->m_symbolTable);
+  ReadSymbolTable(reader, model->m_ignoreTable);
+  model->m_start = ReadList<Module>(reader);
+  if (auto rules = ReadList<Production>(reader); rules != nullptr)
+  {
+    model->m_rules->append(rules.get());
+  }
+  return model;
+}
+
 auto LSysModel::ResetArgument(const std::string& name, const Value& newValue) -> void
 {
   if (Value value; not m_symbolTable.Lookup(name, value))
@@ -50,46 +134,452 @@ auto LSysModel::ResetArgument(const std::string& name, const Value& newValue) ->
     throw std::runtime_error("Could not find argument to reset.");
   }
   m_symbolTable.Enter(name, newValue);
+  m_constants.Update(Name{name.c_str()}, newValue);
+}
+
+auto LSysModel::Clone() const -> std::unique_ptr<LSysModel>
+{
+  auto clone                  = std::make_unique<LSysModel>();
+  clone->m_symbolTable        = m_symbolTable;
+  clone->m_ignoreTable        = m_ignoreTable;
+  clone->m_rules              = m_rules;
+  clone->m_numThreads         = m_numThreads;
+  clone->m_compileExpressions = m_compileExpressions;
+  clone->m_randomEngine       = m_randomEngine;
+  clone->m_rulesByName        = m_rulesByName;
+  clone->m_hasContextRules    = m_hasContextRules;
+  clone->m_hasCutSuccessors   = m_hasCutSuccessors;
+  clone->m_constants          = m_constants;
+  clone->m_numFormalSlots     = m_numFormalSlots;
+  clone->m_start              = m_start;
+  return clone;
+}
+
+auto LSysModel::SetCompileExpressions(const bool compileExpressions) -> void
+{
+  m_compileExpressions = compileExpressions;
+  if (not m_rulesByName.empty())
+  {
+    IndexRules();
+  }
+}
+
+// Build the rule index. Each rule is filed under the name of its
+// predecessor's center module; since the parser appends the context-free
+// rules after the context-sensitive ones, walking the rule list in order
+// preserves the priority of context-sensitive rules within each bucket.
+// The names in each rule are also resolved to formal and constant slots,
+// and its expressions compiled.
+auto LSysModel::IndexRules() -> void
+{
+  // Clones rely on the slots and compiled code of the shared rules.
+  if (m_rules.use_count() > 1)
+  {
+    throw std::runtime_error("LSysModel::IndexRules: the rules are shared with a clone.");
+  }
+
+  m_rulesByName.clear();
+  m_hasContextRules  = false;
+  m_hasCutSuccessors = false;
+  m_numFormalSlots   = 0;
+
+  auto ruleIter = ListIterator<Production>{*m_rules};
+  for (auto* rule = ruleIter.first(); rule != nullptr; rule = ruleIter.next())
+  {
+    m_hasContextRules  = m_hasContextRules or (not rule->IsContextFree());
+    m_hasCutSuccessors = m_hasCutSuccessors or rule->HasSuccessorModule(GetCutName());
+    m_numFormalSlots   = std::max(m_numFormalSlots, rule->ResolveNames(m_constants, m_symbolTable));
+    rule->SetCompiled(m_compileExpressions);
+
+    const auto nameId = static_cast<size_t>(rule->GetPredecessorName().id());
+    if (nameId >= m_rulesByName.size())
+    {
+      m_rulesByName.resize(nameId + 1);
+    }
+    m_rulesByName[nameId].push_back(rule);
+  }
+}
+
+namespace
+{
+
+// Parallel generation only pays off if each chunk has a reasonable amount of work.
+constexpr auto MIN_MODULES_PER_CHUNK = 1024U;
+// Use more chunks than threads so uneven chunks balance out.
+constexpr auto CHUNKS_PER_THREAD = 4U;
+// Number of modules passed to a stream consumer at a time.
+constexpr auto STREAM_CHUNK_SIZE = 4096U;
+
+auto SaturatingAdd(const uint64_t a, const uint64_t b) noexcept -> uint64_t
+{
+  return (a > (std::numeric_limits<uint64_t>::max() - b)) ? std::numeric_limits<uint64_t>::max()
+                                                           : a + b;
+}
+
+auto SaturatingMultiply(const uint64_t a, const uint64_t b) noexcept -> uint64_t
+{
+  if ((0 == a) or (0 == b))
+  {
+    return 0;
+  }
+  return (a > (std::numeric_limits<uint64_t>::max() / b)) ? std::numeric_limits<uint64_t>::max()
+                                                          : a * b;
+}
+
+} // namespace
+
+// Apply the model to the specified string for one generation, generating a new string.
+auto LSysModel::Generate(const ModuleString& oldModules, ModuleString& newModules) -> void
+{
+  if (m_rulesByName.empty() and (m_rules->size() > 0))
+  {
+    IndexRules();
+  }
+
+  // Clearing keeps the buffers; strings rarely shrink, so also make sure
+  // there is at least as much room as the old string needed.
+  newModules.clear();
+  newModules.reserve(oldModules.size(), oldModules.GetNumValues());
+
+  if ((m_numThreads > 1) and (oldModules.size() >= (2 * MIN_MODULES_PER_CHUNK)))
+  {
+    GenerateParallel(oldModules, newModules);
+  }
+  else
+  {
+    const auto randomEngine = ScopedThreadRandomEngine{m_randomEngine};
+    auto valueFrame         = GetValueFrame();
+    GenerateRange(oldModules, 0, oldModules.size(), valueFrame, newModules);
+  }
+
+  // Context matching in the next generation skips branches via the bracket
+  // index, as does a cut when the final generation is interpreted. A cut in
+  // the start string survives every generation that does not rewrite it.
+  if (m_hasContextRules or m_hasCutSuccessors or oldModules.HasBracketIndex())
+  {
+    newModules.IndexBrackets();
+  }
+}
+
+// Find the first production matching module i, or nullptr if there is none.
+auto LSysModel::FindMatchingRule(const ModuleString& modules,
+                                 const size_t i,
+                                 ValueFrame& valueFrame) const -> const Production*
+{
+  PDebug(PD_PRODUCTION,
+         std::cerr << "Searching for matching production to " << modules.ToString(i) << "\n");
+
+  const auto* const candidateRules = GetCandidateRules(modules.GetNameId(i));
+  if (nullptr == candidateRules)
+  {
+    return nullptr;
+  }
+
+  for (const auto* const candidateRule : *candidateRules)
+  {
+    if (candidateRule->Matches(modules, i, valueFrame))
+    {
+      PDebug(PD_PRODUCTION, std::cerr << "\tmatched by: " << *candidateRule << "\n");
+      return candidateRule;
+    }
+  }
+
+  return nullptr;
+}
+
+// Apply the model to the modules [begin, end) of the old string, appending the
+// results to the new string. Modules outside the range are only used as context.
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+auto LSysModel::GenerateRange(const ModuleString& oldModules,
+                              const size_t begin,
+                              const size_t end,
+                              ValueFrame& valueFrame,
+                              ModuleString& newModules) const -> void
+{
+  for (auto i = begin; i < end; ++i)
+  {
+    // If we find a matching production, replace the module by its successor.
+    if (const auto* const rule = FindMatchingRule(oldModules, i, valueFrame); rule != nullptr)
+    {
+      rule->Produce(oldModules, i, valueFrame, newModules);
+    }
+    else
+    {
+      PDebug(PD_PRODUCTION, std::cerr << "\tno match found, passing production unchanged\n");
+      newModules.Append(oldModules, i);
+    }
+  }
 }
 
-// Apply the model to the specified list for one generation, generating a new list.
-auto LSysModel::Generate(List<Module>* const oldModuleList) -> std::unique_ptr<List<Module>>
+// Split the old string into chunks and rewrite them concurrently. Matching only
+// reads the old string, so the chunks are independent apart from the formal
+// parameters bound while matching, which each chunk gets its own frame for.
+// Each chunk also gets its own random number stream, a jump of the model's
+// engine apart from the previous chunk's, so the result does not depend on
+// which thread happened to process which chunk. The successor strings are
+// stitched back together in order.
+auto LSysModel::GenerateParallel(const ModuleString& oldModules, ModuleString& newModules)
+    -> void
 {
-  auto ruleIter      = ConstListIterator<Production>{m_rules};
-  auto newModuleList = std::make_unique<List<Module>>();
+  const auto numModules = oldModules.size();
+  const auto numChunks  = std::min(static_cast<size_t>(m_numThreads) * CHUNKS_PER_THREAD,
+                                  numModules / MIN_MODULES_PER_CHUNK);
+  const auto chunkSize  = (numModules + numChunks - 1) / numChunks;
 
-  auto oldModIter = ListIterator<Module>{*oldModuleList};
-  for (Module* oldMod = oldModIter.first(); oldMod != nullptr; oldMod = oldModIter.next())
+  auto chunkEngines = std::vector<RandomEngine>{};
+  chunkEngines.reserve(numChunks);
+  for (auto chunk = 0U; chunk < numChunks; ++chunk)
   {
-    PDebug(PD_PRODUCTION, std::cerr << "Searching for matching production to " << *oldMod << "\n");
+    m_randomEngine.Jump();
+    chunkEngines.push_back(m_randomEngine);
+  }
 
-    // Find a matching production.
-    // NOTE: This could be optimized a bunch.
-    const Production* rule = nullptr;
-    for (rule = ruleIter.first(); rule != nullptr; rule = ruleIter.next())
+  if (m_chunkStrings.size() < numChunks)
+  {
+    m_chunkStrings.resize(numChunks);
+  }
+  auto nextChunk    = std::atomic<size_t>{0};
+  const auto worker = [&]()
+  {
+    for (auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
     {
-      if (rule->Matches(oldModIter, oldMod, m_symbolTable))
+      const auto randomEngine = ScopedThreadRandomEngine{chunkEngines[chunk]};
+      auto valueFrame         = GetValueFrame();
+      m_chunkStrings[chunk].clear();
+      GenerateRange(oldModules,
+                    chunk * chunkSize,
+                    std::min(numModules, (chunk + 1) * chunkSize),
+                    valueFrame,
+                    m_chunkStrings[chunk]);
+    }
+  };
+
+  auto workers = std::vector<std::future<void>>{};
+  for (auto i = 0U; i < std::min(static_cast<size_t>(m_numThreads), numChunks); ++i)
+  {
+    workers.emplace_back(std::async(std::launch::async, worker));
+  }
+  for (auto& thread : workers)
+  {
+    thread.get();
+  }
+
+  auto newNumModules = size_t{0};
+  auto newNumValues  = size_t{0};
+  for (auto chunk = 0U; chunk < numChunks; ++chunk)
+  {
+    newNumModules += m_chunkStrings[chunk].size();
+    newNumValues += m_chunkStrings[chunk].GetNumValues();
+  }
+  newModules.reserve(newNumModules, newNumValues);
+  for (auto chunk = 0U; chunk < numChunks; ++chunk)
+  {
+    newModules.Append(m_chunkStrings[chunk]);
+  }
+}
+
+auto LSysModel::DeriveStream(const ModuleString& startModules,
+                             const int maxGen,
+                             const StreamConsumer& consumer) -> void
+{
+  if (m_rulesByName.empty() and (m_rules->size() > 0))
+  {
+    IndexRules();
+  }
+  if (m_hasContextRules)
+  {
+    throw std::runtime_error("Streaming derivation needs a context-free model.");
+  }
+
+  auto state = StreamState{
+      .maxGen     = maxGen,
+      .consumer   = &consumer,
+      .valueFrame = GetValueFrame(),
+      .successors = std::vector<ModuleString>(static_cast<size_t>(std::max(0, maxGen))),
+      .output     = ModuleString{},
+  };
+  state.output.reserve(STREAM_CHUNK_SIZE, STREAM_CHUNK_SIZE);
+
+  const auto randomEngine = ScopedThreadRandomEngine{m_randomEngine};
+  DeriveDepthFirst(startModules, 0, state);
+
+  consumer(state.output);
+}
+
+// Expand each module of a generation 'gen' string in turn, recursing on its
+// successor until the last generation is reached. A module with no rules is
+// never rewritten, so it goes straight to the output.
+// NOLINTNEXTLINE(misc-no-recursion)
+auto LSysModel::DeriveDepthFirst(const ModuleString& modules, const int gen, StreamState& state)
+    -> void
+{
+  for (auto i = 0U; i < modules.size(); ++i)
+  {
+    if ((gen >= state.maxGen) or (nullptr == GetCandidateRules(modules.GetNameId(i))))
+    {
+      state.output.Append(modules, i);
+      if (state.output.size() >= STREAM_CHUNK_SIZE)
       {
-        PDebug(PD_PRODUCTION, std::cerr << "\tmatched by: " << *rule << "\n");
-        break;
+        (*state.consumer)(state.output);
+        state.output.clear();
       }
+      continue;
     }
-    // If we found one, replace the module by its successor.
-    if (rule != nullptr)
+
+    auto& successor = state.successors[static_cast<size_t>(gen)];
+    successor.clear();
+    if (const auto* const rule = FindMatchingRule(modules, i, state.valueFrame); rule != nullptr)
     {
-      const auto result = rule->Produce(oldMod, m_symbolTable);
-      PDebug(PD_PRODUCTION, std::cerr << "\tapplied production yielding: " << *result << "\n");
-      newModuleList->append(result.get());
+      rule->Produce(modules, i, state.valueFrame, successor);
     }
     else
     {
-      PDebug(PD_PRODUCTION, std::cerr << "\tno match found, passing production unchanged\n");
-      auto oldModPtr = std::make_unique<Module>(*oldMod);
-      newModuleList->append(std::move(oldModPtr));
+      successor.Append(modules, i);
     }
+
+    DeriveDepthFirst(successor, gen + 1, state);
   }
+}
 
-  return newModuleList;
+// In a D0L model, a module is rewritten by the same successor whatever its
+// parameter values, so the string is fully described by how many modules of
+// each kind (name and number of parameters) it holds, and each generation is
+// a vector times the matrix of successor counts. The matrix is sparse, so
+// only the kinds reachable from the start string are visited.
+auto LSysModel::PredictGenerationSizes(const int maxGen) -> std::vector<GenerationSize>
+{
+  if (m_rulesByName.empty() and (m_rules->size() > 0))
+  {
+    IndexRules();
+  }
+  if (nullptr == m_start)
+  {
+    throw std::runtime_error("PredictGenerationSizes: model has no start string.");
+  }
+
+  struct ModuleKind
+  {
+    int nameId;
+    size_t numParams;
+    bool rewritten = false;
+    std::vector<std::pair<size_t, uint64_t>> successorCounts{};
+  };
+  auto kinds       = std::vector<ModuleKind>{};
+  auto kindIndices = std::map<std::pair<int, size_t>, size_t>{};
+  auto counts      = std::vector<uint64_t>{};
+
+  const auto getKind = [&kinds, &kindIndices](const Module& module)
+  {
+    const auto key = std::pair{module.GetName().id(), module.GetNumParams()};
+    if (const auto kind = kindIndices.find(key); kind != kindIndices.end())
+    {
+      return kind->second;
+    }
+    kinds.push_back({.nameId = key.first, .numParams = key.second});
+    kindIndices.emplace(key, kinds.size() - 1);
+    return kinds.size() - 1;
+  };
+
+  // A module is rewritten by the first candidate rule it conforms to.
+  const auto addSuccessors = [this, &kinds, &getKind](const size_t kindIndex)
+  {
+    const auto* const candidateRules = GetCandidateRules(kinds[kindIndex].nameId);
+    if (nullptr == candidateRules)
+    {
+      return;
+    }
+    for (const auto* const rule : *candidateRules)
+    {
+      if (rule->GetPredecessorNumParams() != kinds[kindIndex].numParams)
+      {
+        continue;
+      }
+      if (not rule->IsDeterministic())
+      {
+        throw std::runtime_error("Cannot predict generation sizes; the model is not a D0L-system.");
+      }
+      auto successorCounts = std::map<size_t, uint64_t>{};
+      auto moduleIter      = ConstListIterator<Module>{rule->GetDeterministicSuccessor()};
+      for (const auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
+      {
+        ++successorCounts[getKind(*module)];
+      }
+      // Index kinds again; getKind may have grown it.
+      kinds[kindIndex].rewritten = true;
+      kinds[kindIndex].successorCounts.assign(successorCounts.begin(), successorCounts.end());
+      return;
+    }
+  };
+
+  auto moduleIter = ConstListIterator<Module>{*m_start};
+  for (const auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
+  {
+    const auto kindIndex = getKind(*module);
+    counts.resize(kinds.size(), 0);
+    ++counts[kindIndex];
+  }
+
+  const auto getGenerationSize = [&kinds, &counts]()
+  {
+    auto size = GenerationSize{.numModules = 0, .numValues = 0};
+    for (auto i = 0U; i < counts.size(); ++i)
+    {
+      size.numModules = SaturatingAdd(size.numModules, counts[i]);
+      size.numValues =
+          SaturatingAdd(size.numValues, SaturatingMultiply(counts[i], kinds[i].numParams));
+    }
+    return size;
+  };
+
+  auto sizes           = std::vector<GenerationSize>{getGenerationSize()};
+  auto numKindsVisited = 0U;
+  for (auto gen = 1; gen <= maxGen; ++gen)
+  {
+    // Find the successors of the kinds first seen in the last generation.
+    for (; numKindsVisited < kinds.size(); ++numKindsVisited)
+    {
+      addSuccessors(numKindsVisited);
+    }
+
+    auto newCounts = std::vector<uint64_t>(kinds.size(), 0);
+    for (auto i = 0U; i < counts.size(); ++i)
+    {
+      if (not kinds[i].rewritten)
+      {
+        newCounts[i] = SaturatingAdd(newCounts[i], counts[i]);
+        continue;
+      }
+      for (const auto& [successor, count] : kinds[i].successorCounts)
+      {
+        newCounts[successor] =
+            SaturatingAdd(newCounts[successor], SaturatingMultiply(counts[i], count));
+      }
+    }
+    counts = std::move(newCounts);
+    sizes.push_back(getGenerationSize());
+  }
+
+  return sizes;
+}
+
+auto LSysModel::GetValueFrame() const -> ValueFrame
+{
+  return ValueFrame{m_symbolTable, m_constants.GetValues(), m_numFormalSlots};
+}
+
+auto LSysModel::GetStartModuleString() const -> std::unique_ptr<ModuleString>
+{
+  auto startModules = std::make_unique<ModuleString>();
+  if (m_start != nullptr)
+  {
+    Instantiate(*m_start, ValueFrame{m_symbolTable}, *startModules);
+  }
+  if (m_hasContextRules or m_hasCutSuccessors or
+      ((m_start != nullptr) and HasModule(*m_start, GetCutName())))
+  {
+    startModules->IndexBrackets();
+  }
+  return startModules;
 }
 
 } // namespace LSYS
@@ -1,33 +1,616 @@
-#ifdef __clang__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
-#pragma GCC diagnostic ignored "-Wcovered-switch-default"
-#pragma GCC diagnostic ignored "-Wmissing-variable-declarations"
-#pragma GCC diagnostic ignored "-Wextra-semi-stmt"
-#pragma GCC diagnostic ignored "-Wundef"
-#pragma GCC diagnostic ignored "-Wmissing-prototypes"
-#pragma GCC diagnostic ignored "-Wunused-macros"
-#pragma GCC diagnostic ignored "-Wmissing-noreturn"
-#endif
-
-#ifdef __GNUC__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-declarations"
-#pragma GCC diagnostic ignored "-Wnull-dereference"
-#endif
-
-// NOLINTBEGIN
-
-#define YY_SKIP_YYWRAP
-
-#include "lex.yy.c"
-
-// NOLINTEND
-
-#ifdef __GNUC__
-#pragma GCC diagnostic pop
-#endif
-
-#ifdef __clang__
-#pragma GCC diagnostic pop
-#endif
+#include "token.h" // Make sure this the first include to avoid name clashes
+
+#include "debug.h"
+#include "lexdefs.h"
+#include "lexer.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace LSYS
+{
+
+namespace
+{
+
+// The scanner rules, in the order of the original lex specification:
+//  when several rules give the longest match, the earliest one wins.
+enum class Rule : int
+{
+  COMMENT,             // "/*"(\*[^/]|[^*]+)*"*/"
+  IGNORE_KEYWORD,      // #ignore
+  INCLUDE_KEYWORD,     // #include
+  DEFINE_KEYWORD,      // #define
+  START_KEYWORD,       // START
+  YIELDS_ARROW,        // ->
+  MODULE_NAME,         // <MODULE>{A}{D}*|Fl|Fr
+  MODULE_SPECIAL_NAME, // <MODULE>@{A}*|~{A}*
+  MODULE_DIGIT,        // <MODULE>{D}
+  MODULE_OPERATOR,     // <MODULE>[+^/&|%~!-]
+  EXPRESSION_NAME,     // <EXPRESSION>{A}({A}|{D})*
+  EXPRESSION_INTEGER,  // <EXPRESSION>{D}+
+  EXPRESSION_REAL,     // <EXPRESSION>{D}+"."{D}*({E})?
+  FRACTION_REAL,       // {D}*"."{D}+({E})?
+  EXPONENT_REAL,       // {D}+{E}E
+  LESS_EQUAL,          // <EXPRESSION><=
+  EQUAL,               // <EXPRESSION>==
+  ASSIGN,              // <EXPRESSION>=
+  GREATER_EQUAL,       // <EXPRESSION>>=
+  NOT_EQUAL,           // <EXPRESSION>!=
+  LOGICAL_AND,         // <EXPRESSION>&&
+  LOGICAL_OR,          // <EXPRESSION>||
+  EXPRESSION_OPERATOR, // <EXPRESSION>[+^/&|~%!-]
+  PUNCTUATION,         // [*:(),<>]
+  NAME_CHAR,           // [[\]{}\\$\.']
+  SPACE,               // [ \t]+
+  CONTINUATION,        // \\\n
+  NEWLINE,             // \n
+  OTHER,               // .
+  NUM_RULES,
+};
+
+constexpr auto NUM_CHARS = 256U;
+
+struct Match
+{
+  Rule rule;
+  size_t length;
+};
+
+[[nodiscard]] constexpr auto IsAlpha(const char chr) noexcept -> bool
+{
+  return ((chr >= 'A') and (chr <= 'Z')) or ((chr >= 'a') and (chr <= 'z')) or (chr == '_');
+}
+
+[[nodiscard]] constexpr auto IsDigit(const char chr) noexcept -> bool
+{
+  return (chr >= '0') and (chr <= '9');
+}
+
+[[nodiscard]] constexpr auto IsOneOf(const char chr, const std::string_view chars) noexcept -> bool
+{
+  return chars.find(chr) != std::string_view::npos;
+}
+
+// Length of the run of characters satisfying 'pred' starting at 'pos'.
+template<typename Pred>
+[[nodiscard]] auto SpanOf(const std::string_view text, const size_t pos, Pred pred) noexcept
+    -> size_t
+{
+  auto end = pos;
+  while ((end < text.size()) and pred(text[end]))
+  {
+    ++end;
+  }
+  return end - pos;
+}
+
+[[nodiscard]] auto SpanOfDigits(const std::string_view text, const size_t pos) noexcept -> size_t
+{
+  return SpanOf(text, pos, IsDigit);
+}
+
+[[nodiscard]] auto MatchLiteral(const std::string_view text,
+                                const std::string_view literal) noexcept -> size_t
+{
+  return text.starts_with(literal) ? literal.size() : 0;
+}
+
+[[nodiscard]] auto MatchOneOf(const std::string_view text, const std::string_view chars) noexcept
+    -> size_t
+{
+  return ((not text.empty()) and IsOneOf(text.front(), chars)) ? 1 : 0;
+}
+
+// {E} = [Ee][-+]?{D}+
+[[nodiscard]] auto MatchExponent(const std::string_view text, const size_t pos) noexcept -> size_t
+{
+  if ((pos >= text.size()) or (not IsOneOf(text[pos], "Ee")))
+  {
+    return 0;
+  }
+  auto end = pos + 1;
+  if ((end < text.size()) and IsOneOf(text[end], "-+"))
+  {
+    ++end;
+  }
+  const auto numDigits = SpanOfDigits(text, end);
+  return (numDigits == 0) ? 0 : ((end + numDigits) - pos);
+}
+
+// The comment can only end at a "*/" whose star does not follow an
+//  unpaired star, so the first such "*/" ends the longest match.
+[[nodiscard]] auto MatchComment(const std::string_view text) noexcept -> size_t
+{
+  if (not text.starts_with("/*"))
+  {
+    return 0;
+  }
+  for (auto pos = 2U; pos < text.size(); ++pos)
+  {
+    if (text[pos] != '*')
+    {
+      continue;
+    }
+    if ((pos + 1) >= text.size())
+    {
+      return 0;
+    }
+    if (text[pos + 1] == '/')
+    {
+      return pos + 2;
+    }
+    ++pos; // '*' and the following character form one unit
+  }
+  return 0;
+}
+
+// <MODULE>{A}{D}*|Fl|Fr
+[[nodiscard]] auto MatchModuleName(const std::string_view text) noexcept -> size_t
+{
+  if (text.empty() or (not IsAlpha(text.front())))
+  {
+    return 0;
+  }
+  const auto length = 1 + SpanOfDigits(text, 1);
+  if ((length == 1) and (text.starts_with("Fl") or text.starts_with("Fr")))
+  {
+    return 2;
+  }
+  return length;
+}
+
+// <MODULE>@{A}*|~{A}*
+[[nodiscard]] auto MatchModuleSpecialName(const std::string_view text) noexcept -> size_t
+{
+  if (text.empty() or (not IsOneOf(text.front(), "@~")))
+  {
+    return 0;
+  }
+  return 1 + SpanOf(text, 1, IsAlpha);
+}
+
+// <EXPRESSION>{A}({A}|{D})*
+[[nodiscard]] auto MatchExpressionName(const std::string_view text) noexcept -> size_t
+{
+  if (text.empty() or (not IsAlpha(text.front())))
+  {
+    return 0;
+  }
+  return 1 + SpanOf(text, 1, [](const char chr) { return IsAlpha(chr) or IsDigit(chr); });
+}
+
+// <EXPRESSION>{D}+"."{D}*({E})?
+[[nodiscard]] auto MatchExpressionReal(const std::string_view text) noexcept -> size_t
+{
+  const auto numDigits = SpanOfDigits(text, 0);
+  if ((numDigits == 0) or (numDigits >= text.size()) or (text[numDigits] != '.'))
+  {
+    return 0;
+  }
+  const auto end = numDigits + 1 + SpanOfDigits(text, numDigits + 1);
+  return end + MatchExponent(text, end);
+}
+
+// {D}*"."{D}+({E})?
+[[nodiscard]] auto MatchFractionReal(const std::string_view text) noexcept -> size_t
+{
+  const auto numDigits = SpanOfDigits(text, 0);
+  if ((numDigits >= text.size()) or (text[numDigits] != '.'))
+  {
+    return 0;
+  }
+  const auto numFractionDigits = SpanOfDigits(text, numDigits + 1);
+  if (numFractionDigits == 0)
+  {
+    return 0;
+  }
+  const auto end = numDigits + 1 + numFractionDigits;
+  return end + MatchExponent(text, end);
+}
+
+// {D}+{E}E
+[[nodiscard]] auto MatchExponentReal(const std::string_view text) noexcept -> size_t
+{
+  const auto numDigits = SpanOfDigits(text, 0);
+  if (numDigits == 0)
+  {
+    return 0;
+  }
+  const auto exponentLength = MatchExponent(text, numDigits);
+  const auto end            = numDigits + exponentLength;
+  if ((exponentLength == 0) or (end >= text.size()) or (text[end] != 'E'))
+  {
+    return 0;
+  }
+  return end + 1;
+}
+
+// Length matched by a rule at the start of 'text', 0 if there is no match.
+//  Rules with a start state only match in that state.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+[[nodiscard]] auto MatchLength(const Rule rule,
+                               const int state,
+                               const std::string_view text) noexcept -> size_t
+{
+  const auto inModule     = state == LEX_MODULE;
+  const auto inExpression = state == LEX_EXPRESSION;
+
+  switch (rule)
+  {
+    case Rule::COMMENT:
+      return MatchComment(text);
+    case Rule::IGNORE_KEYWORD:
+      return MatchLiteral(text, "#ignore");
+    case Rule::INCLUDE_KEYWORD:
+      return MatchLiteral(text, "#include");
+    case Rule::DEFINE_KEYWORD:
+      return MatchLiteral(text, "#define");
+    case Rule::START_KEYWORD:
+      return MatchLiteral(text, "START");
+    case Rule::YIELDS_ARROW:
+      return MatchLiteral(text, "->");
+    case Rule::MODULE_NAME:
+      return inModule ? MatchModuleName(text) : 0;
+    case Rule::MODULE_SPECIAL_NAME:
+      return inModule ? MatchModuleSpecialName(text) : 0;
+    case Rule::MODULE_DIGIT:
+      return (inModule and (not text.empty()) and IsDigit(text.front())) ? 1 : 0;
+    case Rule::MODULE_OPERATOR:
+      return inModule ? MatchOneOf(text, "+^/&|%~!-") : 0;
+    case Rule::EXPRESSION_NAME:
+      return inExpression ? MatchExpressionName(text) : 0;
+    case Rule::EXPRESSION_INTEGER:
+      return inExpression ? SpanOfDigits(text, 0) : 0;
+    case Rule::EXPRESSION_REAL:
+      return inExpression ? MatchExpressionReal(text) : 0;
+    case Rule::FRACTION_REAL:
+      return MatchFractionReal(text);
+    case Rule::EXPONENT_REAL:
+      return MatchExponentReal(text);
+    case Rule::LESS_EQUAL:
+      return inExpression ? MatchLiteral(text, "<=") : 0;
+    case Rule::EQUAL:
+      return inExpression ? MatchLiteral(text, "==") : 0;
+    case Rule::ASSIGN:
+      return inExpression ? MatchLiteral(text, "=") : 0;
+    case Rule::GREATER_EQUAL:
+      return inExpression ? MatchLiteral(text, ">=") : 0;
+    case Rule::NOT_EQUAL:
+      return inExpression ? MatchLiteral(text, "!=") : 0;
+    case Rule::LOGICAL_AND:
+      return inExpression ? MatchLiteral(text, "&&") : 0;
+    case Rule::LOGICAL_OR:
+      return inExpression ? MatchLiteral(text, "||") : 0;
+    case Rule::EXPRESSION_OPERATOR:
+      return inExpression ? MatchOneOf(text, "+^/&|~%!-") : 0;
+    case Rule::PUNCTUATION:
+      return MatchOneOf(text, "*:(),<>");
+    case Rule::NAME_CHAR:
+      return MatchOneOf(text, "[]{}\\$.'");
+    case Rule::SPACE:
+      return SpanOf(text, 0, [](const char chr) { return (chr == ' ') or (chr == '\t'); });
+    case Rule::CONTINUATION:
+      return MatchLiteral(text, "\\\n");
+    case Rule::NEWLINE:
+      return MatchLiteral(text, "\n");
+    case Rule::OTHER:
+      return ((not text.empty()) and (text.front() != '\n')) ? 1 : 0;
+    case Rule::NUM_RULES:
+      break;
+  }
+  return 0;
+}
+
+// The characters each rule's matches can start with; "" for any but a newline.
+constexpr auto ALPHA_CHARS =
+    std::string_view{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_"};
+constexpr auto DIGIT_CHARS = std::string_view{"0123456789"};
+
+[[nodiscard]] constexpr auto GetFirstChars(const Rule rule) noexcept -> std::string_view
+{
+  switch (rule)
+  {
+    case Rule::COMMENT:
+      return "/";
+    case Rule::IGNORE_KEYWORD:
+    case Rule::INCLUDE_KEYWORD:
+    case Rule::DEFINE_KEYWORD:
+      return "#";
+    case Rule::START_KEYWORD:
+      return "S";
+    case Rule::YIELDS_ARROW:
+      return "-";
+    case Rule::MODULE_NAME:
+    case Rule::EXPRESSION_NAME:
+      return ALPHA_CHARS;
+    case Rule::MODULE_SPECIAL_NAME:
+      return "@~";
+    case Rule::MODULE_DIGIT:
+    case Rule::EXPRESSION_INTEGER:
+    case Rule::EXPRESSION_REAL:
+    case Rule::EXPONENT_REAL:
+      return DIGIT_CHARS;
+    case Rule::FRACTION_REAL:
+      return "0123456789.";
+    case Rule::MODULE_OPERATOR:
+      return "+^/&|%~!-";
+    case Rule::LESS_EQUAL:
+      return "<";
+    case Rule::EQUAL:
+    case Rule::ASSIGN:
+      return "=";
+    case Rule::GREATER_EQUAL:
+      return ">";
+    case Rule::NOT_EQUAL:
+      return "!";
+    case Rule::LOGICAL_AND:
+      return "&";
+    case Rule::LOGICAL_OR:
+      return "|";
+    case Rule::EXPRESSION_OPERATOR:
+      return "+^/&|~%!-";
+    case Rule::PUNCTUATION:
+      return "*:(),<>";
+    case Rule::NAME_CHAR:
+      return "[]{}\\$.'";
+    case Rule::SPACE:
+      return " \t";
+    case Rule::CONTINUATION:
+      return "\\";
+    case Rule::NEWLINE:
+      return "\n";
+    case Rule::OTHER:
+    case Rule::NUM_RULES:
+      break;
+  }
+  return "";
+}
+
+using RuleSet = uint32_t;
+static_assert(static_cast<size_t>(Rule::NUM_RULES) <= (8 * sizeof(RuleSet)));
+
+// For each first character, the rules that could match, so a token is only
+//  tried against those.
+[[nodiscard]] consteval auto GetCandidateRules() noexcept -> std::array<RuleSet, NUM_CHARS>
+{
+  auto candidates = std::array<RuleSet, NUM_CHARS>{};
+  for (auto i = 0; i < static_cast<int>(Rule::NUM_RULES); ++i)
+  {
+    const auto ruleBit    = RuleSet{1} << i;
+    const auto firstChars = GetFirstChars(static_cast<Rule>(i));
+    for (auto chr = 0U; chr < NUM_CHARS; ++chr)
+    {
+      if (firstChars.empty() ? (chr != '\n') : IsOneOf(static_cast<char>(chr), firstChars))
+      {
+        candidates.at(chr) |= ruleBit;
+      }
+    }
+  }
+  return candidates;
+}
+
+constexpr auto CANDIDATE_RULES = GetCandidateRules();
+
+[[nodiscard]] auto GetLongestMatch(const int state, const std::string_view text) noexcept -> Match
+{
+  auto longest = Match{Rule::OTHER, 0};
+  for (auto rules = CANDIDATE_RULES[static_cast<unsigned char>(text.front())]; rules != 0;
+       rules &= rules - 1)
+  {
+    const auto rule = static_cast<Rule>(std::countr_zero(rules));
+    if (const auto length = MatchLength(rule, state, text); length > longest.length)
+    {
+      longest = Match{rule, length};
+    }
+  }
+  return longest;
+}
+
+[[nodiscard]] auto SpaceAdd(int curlen, const std::string_view text) noexcept -> int
+{
+  for (const auto chr : text)
+  {
+    if (chr == '\t')
+    {
+      curlen = (curlen + 8) & ~7; // NOLINT(hicpp-signed-bitwise)
+    }
+    else
+    {
+      ++curlen;
+    }
+  }
+  return curlen;
+}
+
+// Count number of newlines in text; keep track of the current column in col.
+[[nodiscard]] auto CountNewlines(const std::string_view text, int& col) noexcept -> int
+{
+  auto numNewlines = 0;
+  for (const auto chr : text)
+  {
+    if (chr == '\n')
+    {
+      ++numNewlines;
+      col = 1;
+    }
+    else if (chr == '\t')
+    {
+      col = (col + 8) & ~7; // NOLINT(hicpp-signed-bitwise)
+    }
+    else
+    {
+      ++col;
+    }
+  }
+  return numNewlines;
+}
+
+} // namespace
+
+Lexer::Lexer(const std::string_view input) noexcept : m_input{input}
+{
+  m_states[0] = LEX_START;
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto Lexer::NextToken() -> int
+{
+  while (m_pos < m_input.size())
+  {
+    const auto rest   = m_input.substr(m_pos);
+    const auto match  = GetLongestMatch(m_states.at(static_cast<size_t>(m_stateTop)), rest);
+    const auto text   = rest.substr(0, match.length);
+    const auto length = static_cast<int>(match.length);
+    m_pos += match.length;
+
+    switch (match.rule)
+    {
+      case Rule::COMMENT:
+        m_column += length;
+        m_line += CountNewlines(text, m_column);
+        break;
+      case Rule::IGNORE_KEYWORD:
+        m_column += length;
+        return LSYS_IGNORE;
+      case Rule::INCLUDE_KEYWORD:
+        m_column += length;
+        return LSYS_INCLUDE;
+      case Rule::DEFINE_KEYWORD:
+        m_column += length;
+        return LSYS_DEFINE;
+      case Rule::START_KEYWORD:
+        m_column += length;
+        return LSYS_START;
+      case Rule::YIELDS_ARROW:
+        m_column += length;
+        return LSYS_YIELDS;
+      case Rule::MODULE_NAME:
+      case Rule::MODULE_SPECIAL_NAME:
+      case Rule::MODULE_DIGIT:
+      case Rule::MODULE_OPERATOR:
+        m_column += length;
+        SaveToken(text);
+        PDebug(PD_LEXER, fprintf(stderr, "lex: module name -> %s\n", m_tokenText.c_str()));
+        return LSYS_NAME;
+      case Rule::EXPRESSION_NAME:
+        m_column += length;
+        SaveToken(text);
+        PDebug(PD_LEXER, fprintf(stderr, "lex: expression name -> %s\n", m_tokenText.c_str()));
+        return LSYS_NAME;
+      case Rule::EXPRESSION_INTEGER:
+        m_column += length;
+        SaveToken(text);
+        PDebug(PD_LEXER, fprintf(stderr, "lex: integer -> %s\n", m_tokenText.c_str()));
+        return LSYS_INTEGER;
+      case Rule::EXPRESSION_REAL:
+      case Rule::FRACTION_REAL:
+      case Rule::EXPONENT_REAL:
+        m_column += length;
+        SaveToken(text);
+        PDebug(PD_LEXER, fprintf(stderr, "lex: real -> %s\n", m_tokenText.c_str()));
+        return LSYS_REAL;
+      case Rule::LESS_EQUAL:
+        m_column += length;
+        return LSYS_LE;
+      case Rule::EQUAL:
+      case Rule::ASSIGN:
+        m_column += length;
+        return LSYS_EQ;
+      case Rule::GREATER_EQUAL:
+        m_column += length;
+        return LSYS_GE;
+      case Rule::NOT_EQUAL:
+        m_column += length;
+        return LSYS_NE;
+      case Rule::LOGICAL_AND:
+        m_column += length;
+        return LSYS_AND;
+      case Rule::LOGICAL_OR:
+        m_column += length;
+        return LSYS_OR;
+      case Rule::EXPRESSION_OPERATOR:
+      case Rule::PUNCTUATION:
+        ++m_column;
+        return text.front();
+      case Rule::NAME_CHAR:
+        ++m_column;
+        SaveToken(text);
+        PDebug(PD_LEXER, fprintf(stderr, "lex: name -> %s\n", m_tokenText.c_str()));
+        return LSYS_NAME;
+      case Rule::SPACE:
+        m_column = SpaceAdd(m_column, text);
+        break;
+      case Rule::CONTINUATION:
+        m_column = 1;
+        ++m_line;
+        break;
+      case Rule::NEWLINE:
+        m_column = 1;
+        ++m_line;
+        return '\n';
+      case Rule::OTHER:
+      case Rule::NUM_RULES:
+        ++m_column;
+        return LSYS_ERROR;
+    }
+  }
+
+  return 0;
+}
+
+// Save the token text for access by the parser.
+auto Lexer::SaveToken(const std::string_view text) -> void
+{
+  m_tokenText.assign(text);
+}
+
+// Change the start state to that indicated by 'state'.
+auto Lexer::SwitchState(const int state, const char* const msg) const -> void
+{
+  switch (state)
+  {
+    case LEX_EXPRESSION:
+      PDebug(PD_LEXER, fprintf(stderr, "%s: BEGIN EXPRESSION\n", msg));
+      break;
+    case LEX_MODULE:
+      PDebug(PD_LEXER, fprintf(stderr, "%s: BEGIN MODULE\n", msg));
+      break;
+    case LEX_START:
+    default:
+      PDebug(PD_LEXER, fprintf(stderr, "%s: BEGIN START\n", msg));
+      break;
+  }
+}
+
+// Push a start state onto the stack and change the start state to match.
+auto Lexer::PushState(const int state) -> void
+{
+  if (m_stateTop >= (STACK_SIZE - 1))
+  {
+    throw std::runtime_error("Lexer::PushState: stack of start states full!");
+  }
+
+  ++m_stateTop;
+  m_states.at(static_cast<size_t>(m_stateTop)) = state;
+  SwitchState(state, "pushstate");
+}
+
+// Pop a start state from the stack and change the start state to match.
+auto Lexer::PopState() -> void
+{
+  if (m_stateTop <= 0)
+  {
+    throw std::runtime_error("Lexer::PopState: stack of start states empty!");
+  }
+
+  --m_stateTop;
+  SwitchState(m_states.at(static_cast<size_t>(m_stateTop)), "popstate");
+}
+
+} // namespace LSYS
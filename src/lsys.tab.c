@@ -55,7 +55,7 @@
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -112,38 +112,10 @@ using LSYS::Predecessor;
 using LSYS::Production;
 using LSYS::Successor;
 using LSYS::Value;
+using LSYS::ValueFrame;
 
-/* default version in liby:yyerror.o as extern "C" void yyerror(char *); */
-void yyerror(const char *);
-
-/* lexical scanner (in lex.yy.o when automatically produced by lex) */
+/* lexical scanner states */
 #include "lexdefs.h"
-extern int yylex(void);
-
-extern void lex_pushstate(int);
-extern void lex_popstate(void);
-extern int lexcol;
-extern int lexline;
-
-/* Return a pointer to the last string token parsed; in lexer */
-extern char *lex_token(void);
-
-
-// Dictionary & rule information needed/generated by the parser
-LSysModel* parseInfo; // GLK
-
-void set_parser_globals(LSysModel* m)
-{
-  parseInfo = m;
-};
-
-
-// A separate list of CF productions is maintained until all
-//  productions have been read.
-static LSYS::List<Production> Context_free_rules;
-
-// Should expressions be evaluated when read in?
-static bool BindExpression = false;
 
 
 
@@ -247,6 +219,13 @@ typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
+/* Unqualified %code blocks.  */
+
+using LSYS::ParseContext;
+
+static int yylex(YYSTYPE* lvalp, ParseContext& context);
+static void yyerror(ParseContext& context, const char* msg);
+
 
 #ifdef short
 # undef short
@@ -629,14 +608,14 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   129,   129,   129,   141,   142,   145,   149,   148,   155,
-     154,   165,   164,   176,   180,   179,   190,   189,   210,   211,
-     214,   225,   236,   242,   245,   251,   260,   264,   263,   293,
-     297,   303,   306,   309,   315,   318,   328,   327,   334,   337,
-     349,   362,   367,   366,   373,   376,   378,   383,   385,   387,
-     389,   391,   393,   395,   397,   399,   401,   403,   405,   407,
-     409,   411,   413,   415,   417,   419,   421,   423,   426,   430,
-     432,   436
+       0,   121,   121,   121,   133,   134,   137,   141,   140,   147,
+     146,   157,   156,   168,   172,   171,   182,   181,   202,   203,
+     206,   217,   228,   234,   237,   243,   252,   256,   255,   285,
+     289,   295,   298,   301,   307,   310,   320,   319,   326,   329,
+     341,   354,   359,   358,   365,   368,   370,   375,   377,   379,
+     381,   383,   385,   387,   389,   391,   393,   395,   397,   399,
+     401,   403,   405,   407,   409,   411,   413,   415,   418,   422,
+     424,   428
 };
 #endif
 
@@ -858,7 +837,7 @@ enum { YYENOMEM = -2 };
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (YY_("syntax error: cannot back up")); \
+        yyerror (context, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
@@ -891,7 +870,7 @@ do {                                                                      \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Kind, Value); \
+                  Kind, Value, context); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -903,10 +882,11 @@ do {                                                                      \
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, LSYS::ParseContext& context)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
+  YY_USE (context);
   if (!yyvaluep)
     return;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
@@ -921,12 +901,12 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, LSYS::ParseContext& context)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, context);
   YYFPRINTF (yyo, ")");
 }
 
@@ -960,7 +940,7 @@ do {                                                            \
 
 static void
 yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
-                 int yyrule)
+                 int yyrule, LSYS::ParseContext& context)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -973,7 +953,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
-                       &yyvsp[(yyi + 1) - (yynrhs)]);
+                       &yyvsp[(yyi + 1) - (yynrhs)], context);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -981,7 +961,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule); \
+    yy_reduce_print (yyssp, yyvsp, Rule, context); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -1022,9 +1002,10 @@ int yydebug;
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, LSYS::ParseContext& context)
 {
   YY_USE (yyvaluep);
+  YY_USE (context);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
@@ -1035,13 +1016,6 @@ yydestruct (const char *yymsg,
 }
 
 
-/* Lookahead token kind.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
@@ -1051,8 +1025,21 @@ int yynerrs;
 `----------*/
 
 int
-yyparse (void)
+yyparse (LSYS::ParseContext& context)
 {
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
     yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
     int yyerrstatus = 0;
@@ -1205,7 +1192,7 @@ yybackup:
   if (yychar == YYEMPTY)
     {
       YYDPRINTF ((stderr, "Reading a token\n"));
-      yychar = yylex ();
+      yychar = yylex (&yylval, context);
     }
 
   if (yychar <= YYEOF)
@@ -1295,55 +1282,55 @@ yyreduce:
   case 2: /* $@1: %empty  */
         {
 		      // Get lex into correct start condition
-		      lex_pushstate(LEX_EXPRESSION);
+		      context.lexer.PushState(LEX_EXPRESSION);
 		    }
     break;
 
   case 3: /* lsystem: $@1 lines  */
                     { // This ensures that CF productions are applied last,
 		      //  since they are at the end of the list of productions.
-		      parserRules.append(&Context_free_rules);
-		      lex_popstate();
+		      parserRules.append(&context.contextFreeRules);
+		      context.lexer.PopState();
 		    }
     break;
 
   case 7: /* $@2: %empty  */
-                    { lex_pushstate(LEX_MODULE); }
+                    { context.lexer.PushState(LEX_MODULE); }
     break;
 
   case 8: /* line: IGNORE $@2 names '\n'  */
-                    { lex_popstate(); }
+                    { context.lexer.PopState(); }
     break;
 
   case 9: /* $@3: %empty  */
                     { Value v;
               if (!parserSymbolTable.Lookup(Name{(yyvsp[-1].name)}.str(), v))
                 parserSymbolTable.Enter(Name{(yyvsp[-1].name)}.str(),
-                                        (yyvsp[0].expression)->Evaluate(parserSymbolTable));
+                                        (yyvsp[0].expression)->Evaluate(ValueFrame{parserSymbolTable}));
 		      delete (yyvsp[0].expression);
 		    }
     break;
 
   case 11: /* $@4: %empty  */
-                    { lex_pushstate(LEX_MODULE);
+                    { context.lexer.PushState(LEX_MODULE);
 		      // Bind starting list expressions according to symtab
-		      BindExpression = true;
+		      context.bindExpression = true;
 		    }
     break;
 
   case 12: /* line: START ':' $@4 modules '\n'  */
-                    { BindExpression = false;
-		      lex_popstate();
+                    { context.bindExpression = false;
+		      context.lexer.PopState();
 		      parserStartReset((yyvsp[-1].moduleList));
 		    }
     break;
 
   case 14: /* $@5: %empty  */
-                    { lex_pushstate(LEX_EXPRESSION); }
+                    { context.lexer.PushState(LEX_EXPRESSION); }
     break;
 
   case 15: /* line: ':' $@5 expression  */
-                    { lex_popstate();
+                    { context.lexer.PopState();
 		      // std::cerr << "Evaluating expression: " << *$3 << std::endl;
 		      // std::cerr << $3->evaluate(parserSymbolTable) << std::endl;
 		      delete (yyvsp[0].expression);
@@ -1351,18 +1338,18 @@ yyreduce:
     break;
 
   case 16: /* $@6: %empty  */
-                    { lex_pushstate(LEX_MODULE); }
+                    { context.lexer.PushState(LEX_MODULE); }
     break;
 
   case 17: /* line: name $@6 ':' predecessor optional_conditional successors  */
-                    { lex_popstate();
+                    { context.lexer.PopState();
 		      auto p = std::make_unique<Production>(Name{(yyvsp[-5].name)},
 		                                    std::unique_ptr<Predecessor>{(yyvsp[-2].predecessor)},
-		                                    std::unique_ptr<const Expression>{(yyvsp[-1].expression)},
-		                                    std::unique_ptr<const List<Successor>>{(yyvsp[0].successors)});
+		                                    std::unique_ptr<Expression>{(yyvsp[-1].expression)},
+		                                    std::unique_ptr<List<Successor>>{(yyvsp[0].successors)});
 		      PDebug(PD_PARSER, std::cerr << "Parsed production: " << *p << std::endl);
 		      if (p->IsContextFree())
-			Context_free_rules.append(std::move(p));
+			context.contextFreeRules.append(std::move(p));
 		      else
 			parserRules.append(std::move(p));
 		    }
@@ -1396,7 +1383,7 @@ yyreduce:
     break;
 
   case 24: /* successor: YIELDS probability modules '\n'  */
-                    { (yyval.successor) = new Successor(std::unique_ptr<const List<Module>>{(yyvsp[-1].moduleList)}, (yyvsp[-2].probability));
+                    { (yyval.successor) = new Successor(std::unique_ptr<List<Module>>{(yyvsp[-1].moduleList)}, (yyvsp[-2].probability));
 		      PDebug(PD_PARSER, std::cerr << "Parsed successor: " << *(yyval.successor) << std::endl);
 		    }
     break;
@@ -1487,11 +1474,11 @@ yyreduce:
     break;
 
   case 36: /* $@8: %empty  */
-                    { lex_pushstate(LEX_EXPRESSION); }
+                    { context.lexer.PushState(LEX_EXPRESSION); }
     break;
 
   case 37: /* arguments: '(' $@8 exprlist ')'  */
-                    { lex_popstate();
+                    { context.lexer.PopState();
 		      (yyval.expressionList) = (yyvsp[-1].expressionList);
 		    }
     break;
@@ -1501,8 +1488,8 @@ yyreduce:
     break;
 
   case 39: /* exprlist: exprlist ',' expression  */
-                    { if (BindExpression == true) {
-			Value v = (yyvsp[0].expression)->Evaluate(parserSymbolTable);
+                    { if (context.bindExpression == true) {
+			Value v = (yyvsp[0].expression)->Evaluate(ValueFrame{parserSymbolTable});
             auto expr = std::make_unique<Expression>(v);
             (yyvsp[-2].expressionList)->append(std::move(expr));
 		      } else {
@@ -1517,8 +1504,8 @@ yyreduce:
   case 40: /* exprlist: expression  */
                     { (yyval.expressionList) = new LSYS::List<Expression>;
 		      PDebug(PD_PARSER, std::cerr << "Parsed expression: " << *(yyvsp[0].expression) << std::endl);
-		      if (BindExpression == true) {
-			Value v = (yyvsp[0].expression)->Evaluate(parserSymbolTable);
+		      if (context.bindExpression == true) {
+			Value v = (yyvsp[0].expression)->Evaluate(ValueFrame{parserSymbolTable});
             auto expr = std::make_unique<Expression>(v);
             (yyval.expressionList)->append(std::move(expr));
 		      } else {
@@ -1533,11 +1520,11 @@ yyreduce:
     break;
 
   case 42: /* $@9: %empty  */
-                    { lex_pushstate(LEX_EXPRESSION); }
+                    { context.lexer.PushState(LEX_EXPRESSION); }
     break;
 
   case 43: /* optional_conditional: ':' $@9 conditional  */
-                    { lex_popstate();
+                    { context.lexer.PopState();
 		      (yyval.expression) = (yyvsp[0].expression);
 		    }
     break;
@@ -1644,16 +1631,16 @@ yyreduce:
     break;
 
   case 69: /* value: INTEGER  */
-                    { (yyval.value) = new Value(std::atoi(lex_token())); }
+                    { (yyval.value) = new Value(std::atoi(context.lexer.GetTokenText().c_str())); }
     break;
 
   case 70: /* value: REAL  */
-                    { (yyval.value) = new Value(std::atof(lex_token())); }
+                    { (yyval.value) = new Value(std::atof(context.lexer.GetTokenText().c_str())); }
     break;
 
   case 71: /* name: NAME  */
-                    { PDebug(PD_NAME, std::cerr << "Calling Name::Name(token @" << ((void *)lex_token()) << " = " << lex_token() << ')' << std::endl);
-		      (yyval.name) = Name{lex_token()}.id();
+                    { PDebug(PD_NAME, std::cerr << "Calling Name::Name(token = " << context.lexer.GetTokenText() << ')' << std::endl);
+		      (yyval.name) = Name{context.lexer.GetTokenText()}.id();
 		    }
     break;
 
@@ -1704,7 +1691,7 @@ yyerrlab:
   if (!yyerrstatus)
     {
       ++yynerrs;
-      yyerror (YY_("syntax error"));
+      yyerror (context, YY_("syntax error"));
     }
 
   if (yyerrstatus == 3)
@@ -1721,7 +1708,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval);
+                      yytoken, &yylval, context);
           yychar = YYEMPTY;
         }
     }
@@ -1777,7 +1764,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, context);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1815,7 +1802,7 @@ yyabortlab:
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (context, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
@@ -1830,7 +1817,7 @@ yyreturnlab:
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval);
+                  yytoken, &yylval, context);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -1839,7 +1826,7 @@ yyreturnlab:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, context);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
@@ -1852,10 +1839,15 @@ yyreturnlab:
 
 
 
-void yyerror(const char *msg) {
+static int yylex(YYSTYPE* /*lvalp*/, ParseContext& context)
+{
+    return context.lexer.NextToken();
+}
+
+static void yyerror(ParseContext& context, const char *msg) {
     std::cout << std::flush;
-    std::cerr << msg << " at line " << lexline << ", column "
-	 << lexcol << "\n" << std::flush;
+    std::cerr << msg << " at line " << context.lexer.GetLine() << ", column "
+	 << context.lexer.GetColumn() << "\n" << std::flush;
 }
 
 
@@ -44,6 +44,13 @@
 #if YYDEBUG
 extern int yydebug;
 #endif
+/* "%code requires" blocks.  */
+
+namespace LSYS
+{
+struct ParseContext;
+}
+
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -101,10 +108,9 @@ typedef union YYSTYPE YYSTYPE;
 #endif
 
 
-extern YYSTYPE yylval;
 
 
-int yyparse (void);
+int yyparse (LSYS::ParseContext& context);
 
 
 #endif /* !YY_YY_LSYS_TAB_H_INCLUDED  */
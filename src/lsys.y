@@ -45,41 +45,33 @@ using LSYS::Predecessor;
 using LSYS::Production;
 using LSYS::Successor;
 using LSYS::Value;
+using LSYS::ValueFrame;
 
-/* default version in liby:yyerror.o as extern "C" void yyerror(char *); */
-void yyerror(const char *);
-
-/* lexical scanner (in lex.yy.o when automatically produced by lex) */
+/* lexical scanner states */
 #include "lexdefs.h"
-extern int yylex(void);
-
-extern void lex_pushstate(int);
-extern void lex_popstate(void);
-extern int lexcol;
-extern int lexline;
-
-/* Return a pointer to the last string token parsed; in lexer */
-extern char *lex_token(void);
 
+%}
 
-// Dictionary & rule information needed/generated by the parser
-LSysModel* parseInfo; // GLK
+/* The parser is reentrant: all of its state, and the lexical scanner, are in
+ *  the ParseContext passed to yyparse.
+ */
+%define api.pure full
+%parse-param {LSYS::ParseContext& context}
+%lex-param {LSYS::ParseContext& context}
 
-void set_parser_globals(LSysModel* m)
+%code requires {
+namespace LSYS
 {
-  parseInfo = m;
-};
-
-
-// A separate list of CF productions is maintained until all
-//  productions have been read.
-static LSYS::List<Production> Context_free_rules;
-
-// Should expressions be evaluated when read in?
-static bool BindExpression = false;
+struct ParseContext;
+}
+}
 
-%}
+%code {
+using LSYS::ParseContext;
 
+static int yylex(YYSTYPE* lvalp, ParseContext& context);
+static void yyerror(ParseContext& context, const char* msg);
+}
 
 %start lsystem
 
@@ -128,13 +120,13 @@ static bool BindExpression = false;
 lsystem     :
         {
 		      // Get lex into correct start condition
-		      lex_pushstate(LEX_EXPRESSION);
+		      context.lexer.PushState(LEX_EXPRESSION);
 		    }
 		lines
 		    { // This ensures that CF productions are applied last,
 		      //  since they are at the end of the list of productions.
-		      parserRules.append(&Context_free_rules);
-		      lex_popstate();
+		      parserRules.append(&context.contextFreeRules);
+		      context.lexer.PopState();
 		    }
 	    ;
 
@@ -146,29 +138,29 @@ line	    :	INCLUDE modules '\n'
 	    ;
 
 line	    :	IGNORE
-		    { lex_pushstate(LEX_MODULE); }
+		    { context.lexer.PushState(LEX_MODULE); }
 		names '\n'
-		    { lex_popstate(); }
+		    { context.lexer.PopState(); }
 	    ;
 
 line	    :	DEFINE name expression
 		    { Value v;
               if (!parserSymbolTable.Lookup(Name{$2}.str(), v))
                 parserSymbolTable.Enter(Name{$2}.str(),
-                                        $3->Evaluate(parserSymbolTable));
+                                        $3->Evaluate(ValueFrame{parserSymbolTable}));
 		      delete $3;
 		    }
 		'\n'
 	    ;
 
 line	    :	START ':'
-		    { lex_pushstate(LEX_MODULE);
+		    { context.lexer.PushState(LEX_MODULE);
 		      // Bind starting list expressions according to symtab
-		      BindExpression = true;
+		      context.bindExpression = true;
 		    }
 		modules '\n'
-		    { BindExpression = false;
-		      lex_popstate();
+		    { context.bindExpression = false;
+		      context.lexer.PopState();
 		      parserStartReset($4);
 		    }
 	    ;
@@ -177,9 +169,9 @@ line	    :	'\n'
 	    ;
 
 line	    :	':'
-		    { lex_pushstate(LEX_EXPRESSION); }
+		    { context.lexer.PushState(LEX_EXPRESSION); }
 		expression
-		    { lex_popstate();
+		    { context.lexer.PopState();
 		      // std::cerr << "Evaluating expression: " << *$3 << std::endl;
 		      // std::cerr << $3->evaluate(parserSymbolTable) << std::endl;
 		      delete $3;
@@ -187,18 +179,18 @@ line	    :	':'
 	    ;
 
 line	    :	name
-		    { lex_pushstate(LEX_MODULE); }
+		    { context.lexer.PushState(LEX_MODULE); }
 		':' predecessor
 		optional_conditional
 		successors
-		    { lex_popstate();
+		    { context.lexer.PopState();
 		      auto p = std::make_unique<Production>(Name{$1},
 		                                    std::unique_ptr<Predecessor>{$4},
-		                                    std::unique_ptr<const Expression>{$5},
-		                                    std::unique_ptr<const List<Successor>>{$6});
+		                                    std::unique_ptr<Expression>{$5},
+		                                    std::unique_ptr<List<Successor>>{$6});
 		      PDebug(PD_PARSER, std::cerr << "Parsed production: " << *p << std::endl);
 		      if (p->IsContextFree())
-			Context_free_rules.append(std::move(p));
+			context.contextFreeRules.append(std::move(p));
 		      else
 			parserRules.append(std::move(p));
 		    }
@@ -243,7 +235,7 @@ optional_successors :
 	    ;
 
 successor   :	YIELDS probability modules '\n'
-		    { $$ = new Successor(std::unique_ptr<const List<Module>>{$3}, $2);
+		    { $$ = new Successor(std::unique_ptr<List<Module>>{$3}, $2);
 		      PDebug(PD_PARSER, std::cerr << "Parsed successor: " << *$$ << std::endl);
 		    }
 	    ;
@@ -325,9 +317,9 @@ module	    :	name
 	    ;
 
 arguments   :	'('
-		    { lex_pushstate(LEX_EXPRESSION); }
+		    { context.lexer.PushState(LEX_EXPRESSION); }
 		exprlist ')'
-		    { lex_popstate();
+		    { context.lexer.PopState();
 		      $$ = $3;
 		    }
 	    |	/* empty */
@@ -335,8 +327,8 @@ arguments   :	'('
 	    ;
 
 exprlist    :	exprlist ',' expression
-		    { if (BindExpression == true) {
-			Value v = $3->Evaluate(parserSymbolTable);
+		    { if (context.bindExpression == true) {
+			Value v = $3->Evaluate(ValueFrame{parserSymbolTable});
             auto expr = std::make_unique<Expression>(v);
             $1->append(std::move(expr));
 		      } else {
@@ -349,8 +341,8 @@ exprlist    :	exprlist ',' expression
 	    |	expression
 		    { $$ = new LSYS::List<Expression>;
 		      PDebug(PD_PARSER, std::cerr << "Parsed expression: " << *$1 << std::endl);
-		      if (BindExpression == true) {
-			Value v = $1->Evaluate(parserSymbolTable);
+		      if (context.bindExpression == true) {
+			Value v = $1->Evaluate(ValueFrame{parserSymbolTable});
             auto expr = std::make_unique<Expression>(v);
             $$->append(std::move(expr));
 		      } else {
@@ -364,9 +356,9 @@ exprlist    :	exprlist ',' expression
 
 optional_conditional :
 		':'
-		    { lex_pushstate(LEX_EXPRESSION); }
+		    { context.lexer.PushState(LEX_EXPRESSION); }
 		conditional
-		    { lex_popstate();
+		    { context.lexer.PopState();
 		      $$ = $3;
 		    }
 	    | /* empty */
@@ -428,22 +420,27 @@ expression  :	expression OR  expression
 	    ;
 
 value	    :	INTEGER
-		    { $$ = new Value(std::atoi(lex_token())); }
+		    { $$ = new Value(std::atoi(context.lexer.GetTokenText().c_str())); }
 	    |	REAL
-		    { $$ = new Value(std::atof(lex_token())); }
+		    { $$ = new Value(std::atof(context.lexer.GetTokenText().c_str())); }
 	    ;
 
 name	    :	NAME
-		    { PDebug(PD_NAME, std::cerr << "Calling Name::Name(token @" << ((void *)lex_token()) << " = " << lex_token() << ')' << std::endl);
-		      $$ = Name{lex_token()}.id();
+		    { PDebug(PD_NAME, std::cerr << "Calling Name::Name(token = " << context.lexer.GetTokenText() << ')' << std::endl);
+		      $$ = Name{context.lexer.GetTokenText()}.id();
 		    }
 	    ;
 %%
 
-void yyerror(const char *msg) {
+static int yylex(YYSTYPE* /*lvalp*/, ParseContext& context)
+{
+    return context.lexer.NextToken();
+}
+
+static void yyerror(ParseContext& context, const char *msg) {
     std::cout << std::flush;
-    std::cerr << msg << " at line " << lexline << ", column "
-	 << lexcol << "\n" << std::flush;
+    std::cerr << msg << " at line " << context.lexer.GetLine() << ", column "
+	 << context.lexer.GetColumn() << "\n" << std::flush;
 }
 
 
@@ -0,0 +1,227 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+module LSys.ModelStream;
+
+import LSys.Name;
+import LSys.Value;
+
+namespace LSYS
+{
+
+namespace
+{
+
+constexpr auto MAGIC           = std::string_view{"LSYSMODL"};
+constexpr auto BYTE_ORDER_MARK = uint32_t{0x01020304U};
+constexpr auto HEADER_SIZE     = MAGIC.size() + (2 * sizeof(uint32_t));
+constexpr auto MAX_SIZE        = std::numeric_limits<uint32_t>::max();
+
+enum class StoredValueType : uint8_t
+{
+  INT,
+  FLOAT,
+  UNDEFINED
+};
+
+} // namespace
+
+template<typename T>
+auto ModelWriter::WriteRaw(const T value) -> void
+{
+  const auto pos = m_fields.size();
+  m_fields.resize(pos + sizeof(T));
+  std::memcpy(m_fields.data() + pos, &value, sizeof(T));
+}
+
+auto ModelWriter::WriteInt(const int32_t value) -> void
+{
+  WriteRaw(value);
+}
+
+auto ModelWriter::WriteSize(const size_t size) -> void
+{
+  if (size > MAX_SIZE)
+  {
+    throw std::runtime_error("ModelWriter: size too large for the compiled model format.");
+  }
+  WriteRaw(static_cast<uint32_t>(size));
+}
+
+auto ModelWriter::WriteFloat(const float value) -> void
+{
+  WriteRaw(value);
+}
+
+auto ModelWriter::WriteBool(const bool value) -> void
+{
+  WriteRaw(static_cast<uint8_t>(value ? 1 : 0));
+}
+
+auto ModelWriter::WriteString(const std::string_view str) -> void
+{
+  WriteSize(str.size());
+  m_fields.append(str);
+}
+
+auto ModelWriter::WriteName(const Name& name) -> void
+{
+  const auto nameId = static_cast<size_t>(name.id());
+  if (nameId >= m_nameIndices.size())
+  {
+    m_nameIndices.resize(nameId + 1, 0);
+  }
+  if (m_nameIndices[nameId] == 0)
+  {
+    m_nameIds.push_back(name.id());
+    m_nameIndices[nameId] = static_cast<int>(m_nameIds.size());
+  }
+  WriteSize(static_cast<size_t>(m_nameIndices[nameId] - 1));
+}
+
+auto ModelWriter::WriteValue(const Value& value) -> void
+{
+  if (auto intValue = 0; value.GetIntValue(intValue))
+  {
+    WriteRaw(StoredValueType::INT);
+    WriteInt(intValue);
+  }
+  else if (auto fltValue = 0.0F; value.GetFloatValue(fltValue))
+  {
+    WriteRaw(StoredValueType::FLOAT);
+    WriteFloat(fltValue);
+  }
+  else
+  {
+    WriteRaw(StoredValueType::UNDEFINED);
+  }
+}
+
+auto ModelWriter::GetBytes() const -> std::string
+{
+  auto header = ModelWriter{};
+  header.m_fields.append(MAGIC);
+  header.WriteRaw(static_cast<uint32_t>(MODEL_FORMAT_VERSION));
+  header.WriteRaw(BYTE_ORDER_MARK);
+  header.WriteSize(m_nameIds.size());
+  for (const auto nameId : m_nameIds)
+  {
+    header.WriteString(Name{nameId}.str());
+  }
+
+  return header.m_fields + m_fields;
+}
+
+ModelReader::ModelReader(const std::string_view bytes) : m_bytes{bytes}
+{
+  if (not bytes.starts_with(MAGIC))
+  {
+    throw std::runtime_error("ModelReader: not a compiled model.");
+  }
+  m_pos = MAGIC.size();
+  if (ReadRaw<uint32_t>() != MODEL_FORMAT_VERSION)
+  {
+    throw std::runtime_error("ModelReader: compiled model has a different format version.");
+  }
+  if (ReadRaw<uint32_t>() != BYTE_ORDER_MARK)
+  {
+    throw std::runtime_error("ModelReader: compiled model has a different byte order.");
+  }
+
+  // Each name takes at least its size, so a count that could not fit in the
+  // rest of the model is corrupt; check it before reserving room for it.
+  const auto numNames = ReadSize();
+  if (numNames > ((m_bytes.size() - m_pos) / sizeof(uint32_t)))
+  {
+    throw std::runtime_error("ModelReader: compiled model is truncated.");
+  }
+  m_nameIds.reserve(numNames);
+  for (auto i = 0U; i < numNames; ++i)
+  {
+    m_nameIds.push_back(Name{ReadString()}.id());
+  }
+}
+
+auto ModelReader::IsModelStream(const std::string_view bytes) noexcept -> bool
+{
+  return (bytes.size() >= HEADER_SIZE) and bytes.starts_with(MAGIC);
+}
+
+template<typename T>
+auto ModelReader::ReadRaw() -> T
+{
+  if (sizeof(T) > (m_bytes.size() - m_pos))
+  {
+    throw std::runtime_error("ModelReader: compiled model is truncated.");
+  }
+  auto value = T{};
+  std::memcpy(&value, m_bytes.data() + m_pos, sizeof(T));
+  m_pos += sizeof(T);
+  return value;
+}
+
+auto ModelReader::ReadInt() -> int32_t
+{
+  return ReadRaw<int32_t>();
+}
+
+auto ModelReader::ReadSize() -> size_t
+{
+  return ReadRaw<uint32_t>();
+}
+
+auto ModelReader::ReadFloat() -> float
+{
+  return ReadRaw<float>();
+}
+
+auto ModelReader::ReadBool() -> bool
+{
+  return ReadRaw<uint8_t>() != 0;
+}
+
+auto ModelReader::ReadString() -> std::string_view
+{
+  const auto size = ReadSize();
+  if (size > (m_bytes.size() - m_pos))
+  {
+    throw std::runtime_error("ModelReader: compiled model is truncated.");
+  }
+  const auto str = m_bytes.substr(m_pos, size);
+  m_pos += size;
+  return str;
+}
+
+auto ModelReader::ReadName() -> Name
+{
+  const auto index = ReadSize();
+  if (index >= m_nameIds.size())
+  {
+    throw std::runtime_error("ModelReader: compiled model has a bad name index.");
+  }
+  return Name{m_nameIds[index]};
+}
+
+auto ModelReader::ReadValue() -> Value
+{
+  switch (ReadRaw<StoredValueType>())
+  {
+    case StoredValueType::INT:
+      return Value{ReadInt()};
+    case StoredValueType::FLOAT:
+      return Value{ReadFloat()};
+    case StoredValueType::UNDEFINED:
+      return Value{};
+  }
+  throw std::runtime_error("ModelReader: compiled model has a bad value type.");
+}
+
+} // namespace LSYS
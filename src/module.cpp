@@ -29,16 +29,22 @@ module;
 
 #include "debug.h"
 
+#include <cstddef>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 
 module LSys.Module;
 
+import LSys.Bytecode;
 import LSys.Expression;
+import LSys.List;
+import LSys.ModelStream;
+import LSys.ModuleString;
 import LSys.Name;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 namespace LSYS
 {
@@ -51,49 +57,60 @@ Module::Module(const Name& name,
   PDebug(PD_MODULE, std::cerr << "Creating module " << *this << " @ " << this << "\n");
 }
 
-// Bind symbolic names of the module to values in module 'values'
-//  using symbol table st for evaluation and binding. The two
+// Bind symbolic names of the module to values of module i of a
+//  module string, setting their slots of the value frame. The two
 //  modules should conform() for this method to succeed.
-auto Module::Bind(const Module& values, SymbolTable<Value>& symbolTable) const -> void
+auto Module::Bind(const ModuleString& values,
+                  const size_t i,
+                  ValueFrame& valueFrame) const -> void
 {
   PDebug(PD_MODULE,
-         std::cerr << "Module::Bind: formals= " << *this << " values= " << values << "\n");
+         std::cerr << "Module::Bind: formals= " << *this << " values= " << values.ToString(i)
+                   << "\n");
 
-  if (not LSYS::Bind(m_param.get(), values.m_param.get(), symbolTable))
+  if (not LSYS::Bind(m_param.get(), values.GetParams(i), valueFrame))
   {
     throw std::runtime_error("Failure binding module.");
   }
 }
 
-// Check if module 'm' is conformant with the module, e.g.,
-//  that they have the same name and their expression lists are
-//  conformant.
-auto Module::Conforms(const Module& mod) const -> bool
+// Check if module i of a module string is conformant with the module,
+//  e.g., that they have the same name and number of parameters.
+auto Module::Conforms(const ModuleString& modules, const size_t i) const -> bool
 {
-  if (m_tag != mod.m_tag)
+  if (m_tag != modules.GetNameId(i))
   {
     return false;
   }
 
-  return LSYS::Conforms(m_param.get(), mod.m_param.get());
+  return GetNumParams() == modules.GetNumParams(i);
 }
 
-// Instantiate the module; that is, return a copy with all of the
-//  module's expressions evaluated in the context of the symbol table.
-auto Module::Instantiate(const SymbolTable<Value>& symbolTable) const -> std::unique_ptr<Module>
+// Instantiate the module; that is, append it to the module string with
+//  all of the module's expressions evaluated in the context of the value frame.
+auto Module::Instantiate(const ValueFrame& valueFrame, ModuleString& moduleString) const -> void
 {
-  auto exprList = LSYS::Instantiate(m_param.get(), symbolTable);
-  if (exprList != nullptr)
+  moduleString.AppendModule(Name(m_tag), m_ignoreFlag);
+
+  if (m_paramCode != nullptr)
+  {
+    for (const auto& value : m_paramCode->Run(valueFrame))
+    {
+      moduleString.AppendParam(value);
+    }
+  }
+  else if (m_param != nullptr)
   {
-    PDebug(PD_MODULE, std::cerr << "        old elist: " << *exprList << "\n");
+    auto exprIter = ConstListIterator<Expression>{*m_param};
+    for (const auto* expr = exprIter.first(); expr != nullptr; expr = exprIter.next())
+    {
+      moduleString.AppendParam(expr->Evaluate(valueFrame));
+    }
   }
 
-  auto newModule = std::make_unique<Module>(Name(m_tag), std::move(exprList), m_ignoreFlag);
   PDebug(PD_MODULE,
-         std::cerr << "Module::Instantiate: " << *this << " @ " << this << " -> " << *newModule
-                   << " @ " << *newModule << "\n");
-
-  return newModule;
+         std::cerr << "Module::Instantiate: " << *this << " @ " << this << " -> "
+                   << moduleString.ToString(moduleString.size() - 1) << "\n");
 }
 
 // Return the nth (0 base) parameter of module in f, if available.
@@ -108,7 +125,55 @@ auto Module::GetFloat(float& fltValue, const unsigned int n) const -> bool
 
   // An empty symbol table used to ensure the argument is a bound value.
   static const auto s_SYMBOL_TABLE = SymbolTable<Value>{};
-  return LSYS::GetFloat(s_SYMBOL_TABLE, *m_param, fltValue, n);
+  static const auto s_VALUE_FRAME  = ValueFrame{s_SYMBOL_TABLE};
+  return LSYS::GetFloat(s_VALUE_FRAME, *m_param, fltValue, n);
+}
+
+auto Module::AddFormalSlots(NameSlots& formalSlots) const -> void
+{
+  LSYS::AddFormalSlots(m_param.get(), formalSlots);
+}
+
+auto Module::ResolveNames(const NameSlots& formalSlots,
+                          ConstantFrame& constants,
+                          const SymbolTable<Value>& symbolTable) -> void
+{
+  LSYS::ResolveNames(m_param.get(), formalSlots, constants, symbolTable);
+}
+
+auto Module::SetCompiled(const bool compiled) -> void
+{
+  m_paramCode.reset();
+  if (compiled)
+  {
+    m_paramCode = std::make_unique<Bytecode>();
+    LSYS::Compile(m_param.get(), *m_paramCode);
+  }
+}
+
+auto Module::Write(ModelWriter& writer) const -> void
+{
+  writer.WriteName(GetName());
+  writer.WriteBool(m_ignoreFlag);
+  WriteList(writer, m_param.get());
+}
+
+auto Module::Read(ModelReader& reader) -> std::unique_ptr<Module>
+{
+  const auto name       = reader.ReadName();
+  const auto ignoreFlag = reader.ReadBool();
+  return std::make_unique<Module>(name, ReadList<Expression>(reader), ignoreFlag);
+}
+
+auto Instantiate(const List<Module>& moduleList,
+                 const ValueFrame& valueFrame,
+                 ModuleString& moduleString) -> void
+{
+  auto modIter = ConstListIterator<Module>{moduleList};
+  for (const auto* mod = modIter.first(); mod != nullptr; mod = modIter.next())
+  {
+    mod->Instantiate(valueFrame, moduleString);
+  }
 }
 
 auto operator<<(std::ostream& out, const Module& mod) -> std::ostream&
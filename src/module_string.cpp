@@ -0,0 +1,319 @@
+module;
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+module LSys.ModuleString;
+
+import LSys.Name;
+import LSys.Value;
+
+namespace LSYS
+{
+
+auto ModuleString::GetMemoryUsage() const noexcept -> size_t
+{
+  return (m_nameIds.capacity() * sizeof(int)) + (m_ignoreFlags.capacity() * sizeof(uint8_t)) +
+         (m_paramOffsets.capacity() * sizeof(uint32_t)) + (m_values.capacity() * sizeof(Value)) +
+         ((m_matchingBracket.capacity() + m_parentBranch.capacity()) * sizeof(uint32_t));
+}
+
+auto ModuleString::clear() noexcept -> void
+{
+  m_nameIds.clear();
+  m_ignoreFlags.clear();
+  m_paramOffsets.resize(1);
+  m_paramOffsets[0] = 0;
+  m_values.clear();
+  m_matchingBracket.clear();
+  m_parentBranch.clear();
+}
+
+auto ModuleString::reserve(const size_t numModules, const size_t numValues) -> void
+{
+  m_nameIds.reserve(numModules);
+  m_ignoreFlags.reserve(numModules);
+  m_paramOffsets.reserve(numModules + 1);
+  m_values.reserve(numValues);
+}
+
+auto ModuleString::GetFloat(const size_t i, float& fltValue, const size_t n) const -> bool
+{
+  if (n >= GetNumParams(i))
+  {
+    return false;
+  }
+
+  return m_values[m_paramOffsets[i] + n].GetFloatValue(fltValue);
+}
+
+auto ModuleString::AppendModule(const Name& name, const bool ignoreFlag) -> void
+{
+  if (m_values.size() >= std::numeric_limits<uint32_t>::max())
+  {
+    throw std::runtime_error("ModuleString: too many module parameters.");
+  }
+
+  m_nameIds.push_back(name.id());
+  m_ignoreFlags.push_back(ignoreFlag ? 1 : 0);
+  m_paramOffsets.push_back(static_cast<uint32_t>(m_values.size()));
+}
+
+auto ModuleString::Append(const ModuleString& other, const size_t i) -> void
+{
+  AppendModule(other.GetName(i), other.Ignore(i));
+  const auto params = other.GetParams(i);
+  m_values.insert(m_values.end(), params.begin(), params.end());
+  m_paramOffsets.back() += static_cast<uint32_t>(params.size());
+}
+
+auto ModuleString::Append(const ModuleString& other) -> void
+{
+  if ((m_values.size() + other.m_values.size()) > std::numeric_limits<uint32_t>::max())
+  {
+    throw std::runtime_error("ModuleString: too many module parameters.");
+  }
+
+  // Offsets of the appended modules are rebased onto the end of the value pool.
+  const auto valueOffset = static_cast<uint32_t>(m_values.size());
+  m_nameIds.insert(m_nameIds.end(), other.m_nameIds.begin(), other.m_nameIds.end());
+  m_ignoreFlags.insert(m_ignoreFlags.end(), other.m_ignoreFlags.begin(), other.m_ignoreFlags.end());
+  for (auto i = 1U; i < other.m_paramOffsets.size(); ++i)
+  {
+    m_paramOffsets.push_back(valueOffset + other.m_paramOffsets[i]);
+  }
+  m_values.insert(m_values.end(), other.m_values.begin(), other.m_values.end());
+
+  assert(m_paramOffsets.size() == (m_nameIds.size() + 1));
+}
+
+// One pass with a stack of open brackets gives both the matching brackets
+// and the branch each module belongs to.
+auto ModuleString::IndexBrackets() -> void
+{
+  if (size() >= NO_BRACKET_INDEX)
+  {
+    throw std::runtime_error("ModuleString: too many modules to index.");
+  }
+
+  m_matchingBracket.assign(size(), NO_BRACKET_INDEX);
+  m_parentBranch.assign(size(), NO_BRACKET_INDEX);
+
+  auto openBrackets = std::vector<uint32_t>{};
+  for (auto i = 0U; i < size(); ++i)
+  {
+    if (IsLeftBracket(i))
+    {
+      m_parentBranch[i] = openBrackets.empty() ? NO_BRACKET_INDEX : openBrackets.back();
+      openBrackets.push_back(i);
+    }
+    else if (IsRightBracket(i))
+    {
+      if (not openBrackets.empty())
+      {
+        const auto left         = openBrackets.back();
+        m_matchingBracket[i]    = left;
+        m_matchingBracket[left] = i;
+        m_parentBranch[i]       = left;
+        openBrackets.pop_back();
+      }
+    }
+    else
+    {
+      m_parentBranch[i] = openBrackets.empty() ? NO_BRACKET_INDEX : openBrackets.back();
+    }
+  }
+}
+
+// Compares name ids directly, as this runs over the whole string before it
+// is interpreted.
+auto ModuleString::GetMaxBracketDepth() const noexcept -> size_t
+{
+  static const auto s_LEFT_BRACKET_ID  = Name{"["}.id();
+  static const auto s_RIGHT_BRACKET_ID = Name{"]"}.id();
+
+  auto depth    = size_t{0};
+  auto maxDepth = size_t{0};
+  for (auto i = 0U; i < size(); ++i)
+  {
+    if (m_ignoreFlags[i] != 0)
+    {
+      continue;
+    }
+    if (m_nameIds[i] == s_LEFT_BRACKET_ID)
+    {
+      maxDepth = std::max(maxDepth, ++depth);
+    }
+    else if ((m_nameIds[i] == s_RIGHT_BRACKET_ID) and (depth > 0))
+    {
+      --depth;
+    }
+  }
+  return maxDepth;
+}
+
+// Unindexed version of GetMatchingBracket.
+auto ModuleString::FindMatchingBracket(const size_t i) const noexcept -> size_t
+{
+  if (IsLeftBracket(i))
+  {
+    auto brackets = 0;
+    for (auto j = i + 1; j < size(); ++j)
+    {
+      if (IsLeftBracket(j))
+      {
+        ++brackets;
+      }
+      else if (IsRightBracket(j))
+      {
+        if (0 == brackets)
+        {
+          return j;
+        }
+        --brackets;
+      }
+    }
+  }
+  else if (IsRightBracket(i))
+  {
+    auto brackets = 0;
+    for (auto j = i; j > 0; --j)
+    {
+      if (IsRightBracket(j - 1))
+      {
+        ++brackets;
+      }
+      else if (IsLeftBracket(j - 1))
+      {
+        if (0 == brackets)
+        {
+          return j - 1;
+        }
+        --brackets;
+      }
+    }
+  }
+
+  return NO_BRACKET;
+}
+
+// Unindexed version of GetBranchEnd.
+auto ModuleString::FindBranchEnd(const size_t i) const noexcept -> size_t
+{
+  if (IsRightBracket(i))
+  {
+    return (FindMatchingBracket(i) == NO_BRACKET) ? NO_BRACKET : i;
+  }
+
+  auto brackets = 0;
+  for (auto j = i; j < size(); ++j)
+  {
+    if (IsRightBracket(j))
+    {
+      if (0 == brackets)
+      {
+        return j;
+      }
+      --brackets;
+    }
+    else if (IsLeftBracket(j))
+    {
+      ++brackets;
+    }
+  }
+
+  return NO_BRACKET;
+}
+
+auto ModuleStringIterator::CutBranch() noexcept -> void
+{
+  if (AtEnd())
+  {
+    return;
+  }
+
+  if (const auto branchEnd = m_moduleString->GetBranchEnd(m_pos);
+      branchEnd != ModuleString::NO_BRACKET)
+  {
+    m_pos = branchEnd - 1;
+    return;
+  }
+
+  // Without the index, stop just before the ] as well; only a resumed cut
+  // stops on it, as there is no module before it to step back to.
+  SkipToBranchEnd(m_pos + 1, 0);
+  if (not AtEnd())
+  {
+    --m_pos;
+  }
+}
+
+auto ModuleStringIterator::ResumeCut(const int pendingCut) noexcept -> void
+{
+  m_pendingCut = NO_CUT;
+  if (pendingCut != NO_CUT)
+  {
+    SkipToBranchEnd(m_pos, pendingCut);
+  }
+}
+
+// Scan from pos for the ] closing the branch, given the number of brackets
+// opened since the cut. Stop on the ] if found, else leave the cut pending.
+auto ModuleStringIterator::SkipToBranchEnd(const size_t pos, int openBrackets) noexcept -> void
+{
+  for (auto j = pos; j < m_moduleString->size(); ++j)
+  {
+    if (m_moduleString->IsRightBracket(j))
+    {
+      if (0 == openBrackets)
+      {
+        m_pos = j;
+        return;
+      }
+      --openBrackets;
+    }
+    else if (m_moduleString->IsLeftBracket(j))
+    {
+      ++openBrackets;
+    }
+  }
+
+  m_pos        = m_moduleString->size();
+  m_pendingCut = openBrackets;
+}
+
+auto ModuleString::Print(std::ostream& out, const size_t i) const -> void
+{
+  out << GetName(i);
+  for (const auto& value : GetParams(i))
+  {
+    out << value;
+  }
+}
+
+auto ModuleString::ToString(const size_t i) const -> std::string
+{
+  auto strStream = std::ostringstream{};
+  Print(strStream, i);
+  return strStream.str();
+}
+
+auto operator<<(std::ostream& out, const ModuleString& moduleString) -> std::ostream&
+{
+  for (auto i = 0U; i < moduleString.size(); ++i)
+  {
+    moduleString.Print(out, i);
+  }
+
+  return out;
+}
+
+} // namespace LSYS
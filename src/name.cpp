@@ -31,62 +31,124 @@ module;
 
 #include "debug.h"
 
-#include <cstdint>
-#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 module LSys.Name;
 
 namespace LSYS
 {
 
-char** Name::s_reverseMap       = nullptr;
-int Name::s_nextIndex           = 0;
-uint32_t Name::s_reverseMapSize = 0U;
+namespace
+{
 
-// Amount to extend name table by when it fills up.
-static constexpr auto MAP_INCR = 20;
+// Size of the first block of interned strings; each block after it doubles.
+constexpr auto FIRST_BLOCK_SIZE = 4096U;
 
-Name::Name(const char* name)
+// The strings of interned names, and the ids they were given. Created on
+// first use, so names can be interned during static initialization.
+class NameInterner
 {
-  if (nullptr == name)
+public:
+  [[nodiscard]] auto Find(const std::string_view name) const -> int
   {
-    name = "";
+    const auto lock = std::shared_lock{m_mutex};
+    const auto iter = m_ids.find(name);
+    return (iter == m_ids.end()) ? -1 : iter->second;
   }
 
-  PDebug(PD_NAME, std::cerr << "Name(" << name << std::flush << "= " << name << ")\n");
-
-  // If the name already exists in the symbol table, use the assigned
-  // hash value. Otherwise, enter it in the table with the next
-  // sequential value.
-  if (s_map.Lookup(name, m_index))
+  // Insert a name, unless another thread got there first, and return its id.
+  // The caller publishes the string of a new id before returning it.
+  template<typename Publish>
+  auto Insert(const std::string_view name, const Publish& publish) -> int
   {
-    return;
+    const auto lock = std::unique_lock{m_mutex};
+    if (const auto iter = m_ids.find(name); iter != m_ids.end())
+    {
+      return iter->second;
+    }
+    if (m_ids.size() >= static_cast<size_t>(std::numeric_limits<int>::max()))
+    {
+      throw std::runtime_error("Name: too many names.");
+    }
+
+    const auto stored = Store(name);
+    const auto id     = static_cast<int>(m_ids.size());
+    publish(id, stored);
+    m_ids.emplace(stored, id);
+    return id;
   }
 
-  if (s_nextIndex == static_cast<int>(s_reverseMapSize))
-  {
-    // Allocate more space for the inverse map from IDs to strings
-    //GLK int size= reverse_map_size + map_incr;
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-    auto** const strPtr = new char*[s_reverseMapSize + MAP_INCR];
+private:
+  mutable std::shared_mutex m_mutex{};
+  std::unordered_map<std::string_view, int> m_ids{};
+  std::vector<std::unique_ptr<char[]>> m_blocks{}; // NOLINT(*-avoid-c-arrays)
+  size_t m_blockSize = 0;
+  size_t m_blockUsed = 0;
 
-    for (auto i = 0U; i < s_reverseMapSize; ++i)
+  // Copy a string, null terminated, into the current block.
+  auto Store(const std::string_view name) -> std::string_view
+  {
+    if ((m_blockUsed + name.size() + 1) > m_blockSize)
     {
-      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-      strPtr[i] = s_reverseMap[i];
+      m_blockSize = std::max({size_t{FIRST_BLOCK_SIZE}, 2 * m_blockSize, name.size() + 1});
+      m_blocks.push_back(std::make_unique_for_overwrite<char[]>(m_blockSize)); // NOLINT
+      m_blockUsed = 0;
     }
-    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-    delete[] s_reverseMap;
-    s_reverseMap = strPtr;
-    s_reverseMapSize += MAP_INCR;
+
+    auto* const dest = m_blocks.back().get() + m_blockUsed;
+    std::ranges::copy(name, dest);
+    dest[name.size()] = '\0'; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    m_blockUsed += name.size() + 1;
+
+    return std::string_view{dest, name.size()};
+  }
+};
+
+[[nodiscard]] auto GetInterner() -> NameInterner&
+{
+  static auto s_interner = NameInterner{};
+  return s_interner;
+}
+
+} // namespace
+
+auto Name::Intern(const std::string_view name) -> int
+{
+  PDebug(PD_NAME, std::cerr << "Name(" << name << ")\n");
+
+  auto& interner = GetInterner();
+  if (const auto id = interner.Find(name); id >= 0)
+  {
+    return id;
   }
 
-  s_map.Enter(name, s_nextIndex);
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-  s_reverseMap[s_nextIndex] = ::strdup(name);
-  m_index                   = s_nextIndex;
-  ++s_nextIndex;
+  return interner.Insert(
+      name,
+      [](const int id, const std::string_view stored)
+      {
+        const auto pos = GetSegmentPos(id);
+        auto* segment  = s_segments[pos.segment].load(std::memory_order_relaxed);
+        if (segment == nullptr)
+        {
+          // Segments are never freed; readers may hold views of them at exit.
+          // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+          segment = new std::string_view[FIRST_SEGMENT_SIZE << pos.segment];
+          s_segments[pos.segment].store(segment, std::memory_order_release);
+        }
+        segment[pos.offset] = stored; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        s_numNames.store(id + 1, std::memory_order_release);
+      });
 }
 
 auto operator<<(std::ostream& out, const Name& name) -> std::ostream&
@@ -14,11 +14,23 @@ module;
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#define LSYS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 module LSys.ParsedModel;
 
 import LSys.Expression;
 import LSys.LSysModel;
+import LSys.ModelStream;
+import LSys.Rand;
 import LSys.SymbolTable;
 
 namespace LSYS
@@ -48,21 +60,122 @@ auto SetSymbolTableValues(SymbolTable<Value>& symbolTable, const Properties& pro
   }
 }
 
+[[nodiscard]] auto GetFinishedModel(std::unique_ptr<LSysModel> model) -> std::unique_ptr<LSysModel>
+{
+  if (model->GetStartModuleList() == nullptr)
+  {
+    std::cerr << "No starting module list.\n";
+    throw std::runtime_error("No starting module list.");
+  }
+
+  model->IndexRules();
+
+  PDebug(PD_MAIN, std::cerr << "Starting module list: " << *model->GetStartModuleList() << "\n");
+  PDebug(PD_PRODUCTION, std::cerr << "\nProductions:\n" << model->GetRules() << "\n");
+
+  return model;
+}
+
+// A read-only view of a whole file, memory-mapped where the platform
+//  allows it, so the parser scans the file's pages without copying them.
+class InputFile
+{
+public:
+  explicit InputFile(const std::string& filename);
+  InputFile(const InputFile&)                    = delete;
+  InputFile(InputFile&&)                         = delete;
+  auto operator=(const InputFile&) -> InputFile& = delete;
+  auto operator=(InputFile&&) -> InputFile&      = delete;
+  ~InputFile() noexcept;
+
+  [[nodiscard]] auto GetContents() const noexcept -> std::string_view { return m_contents; }
+
+private:
+  std::string_view m_contents{};
+#ifndef LSYS_HAS_MMAP
+  std::string m_buffer{};
+#endif
+};
+
+#ifdef LSYS_HAS_MMAP
+
+InputFile::InputFile(const std::string& filename)
+{
+  const auto fileDescriptor = ::open(filename.c_str(), O_RDONLY); // NOLINT
+  if (fileDescriptor < 0)
+  {
+    std::cerr << "Can't open input file " << filename << "\n";
+    throw std::runtime_error("Can't open input file.");
+  }
+
+  struct stat fileStat{};
+  if (::fstat(fileDescriptor, &fileStat) != 0)
+  {
+    ::close(fileDescriptor);
+    throw std::runtime_error("Can't get the size of the input file.");
+  }
+
+  // An empty file cannot be mapped, and needs no mapping.
+  const auto size = static_cast<size_t>(fileStat.st_size);
+  if (size > 0)
+  {
+    void* const address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    ::close(fileDescriptor);
+    if (address == MAP_FAILED) // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+    {
+      throw std::runtime_error("Can't map the input file.");
+    }
+    ::madvise(address, size, MADV_SEQUENTIAL);
+    m_contents = std::string_view{static_cast<const char*>(address), size};
+  }
+  else
+  {
+    ::close(fileDescriptor);
+  }
+}
+
+InputFile::~InputFile() noexcept
+{
+  if (not m_contents.empty())
+  {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<char*>(m_contents.data()), m_contents.size());
+  }
+}
+
+#else
+
+InputFile::InputFile(const std::string& filename)
+{
+  auto inputFile = std::ifstream{filename, std::ios::binary};
+  if (not inputFile.good())
+  {
+    std::cerr << "Can't open input file " << filename << "\n";
+    throw std::runtime_error("Can't open input file.");
+  }
+  auto buffer = std::ostringstream{};
+  buffer << inputFile.rdbuf();
+  m_buffer   = std::move(buffer).str();
+  m_contents = m_buffer;
+}
+
+InputFile::~InputFile() noexcept = default;
+
+#endif
+
 } // namespace
 
 auto SetParserDebug(const bool debugOn) noexcept -> void
 {
   if (debugOn)
   {
-    ParseDebug    = 1;
-    yy_flex_debug = 1;
-    yydebug       = 1;
+    ParseDebug = 1;
+    yydebug    = 1;
   }
   else
   {
-    ParseDebug    = 0;
-    yy_flex_debug = 0;
-    yydebug       = 0;
+    ParseDebug = 0;
+    yydebug    = 0;
   }
 }
 
@@ -153,25 +266,59 @@ auto SetParserDebug(const bool debugOn) noexcept -> void
     throw std::runtime_error("Could not find input file.");
   }
 
+  const auto inputFile = InputFile{properties.inputFilename};
+
+  if (ModelReader::IsModelStream(inputFile.GetContents()))
+  {
+    return GetCompiledModel(inputFile.GetContents(), properties);
+  }
+  return GetParsedModel(inputFile.GetContents(), properties);
+}
+
+[[nodiscard]] auto GetParsedModel(const std::string_view modelText, const Properties& properties)
+    -> std::unique_ptr<LSysModel>
+{
   auto model = std::make_unique<LSysModel>();
+  model->SetSeed(properties.seed);
 
   SetSymbolTableValues(model->GetSymbolTable(), properties);
 
-  ::set_parser_globals(model.get());
-  ::set_parser_input(properties.inputFilename.c_str());
+  // Expressions evaluated while parsing draw from the model's engine too.
+  const auto randomEngine = ScopedThreadRandomEngine{model->GetRandomEngine()};
+  auto context            = ParseContext{*model, modelText};
+  ::yyparse(context); // Parse model text
 
-  ::yyparse(); // Parse input file
+  return GetFinishedModel(std::move(model));
+}
 
-  if (model->GetStartModuleList() == nullptr)
+[[nodiscard]] auto GetCompiledModel(const std::string_view modelBytes, const Properties& properties)
+    -> std::unique_ptr<LSysModel>
+{
+  auto reader = ModelReader{modelBytes};
+  auto model  = LSysModel::Read(reader);
+  if (not reader.AtEnd())
   {
-    std::cerr << "No starting module list.\n";
-    throw std::runtime_error("No starting module list.");
+    throw std::runtime_error("Compiled model has trailing data.");
   }
+  model->SetSeed(properties.seed);
 
-  PDebug(PD_MAIN, std::cerr << "Starting module list: " << *model->GetStartModuleList() << "\n");
-  PDebug(PD_PRODUCTION, std::cerr << "\nProductions:\n" << model->GetRules() << "\n");
+  SetSymbolTableValues(model->GetSymbolTable(), properties);
 
-  return model;
+  return GetFinishedModel(std::move(model));
+}
+
+auto WriteCompiledModel(const LSysModel& model, const std::string& filename) -> void
+{
+  auto writer = ModelWriter{};
+  model.Write(writer);
+
+  auto outputFile = std::ofstream{filename, std::ios::binary};
+  outputFile << writer.GetBytes();
+  if (not outputFile.good())
+  {
+    std::cerr << "Could not write compiled model '" << filename << "'.\n";
+    throw std::runtime_error("Could not write compiled model.");
+  }
 }
 
 namespace
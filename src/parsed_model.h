@@ -4,5 +4,3 @@
 
 int ParseDebug = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 extern int yydebug; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
-// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables, readability-identifier-naming)
-extern int yy_flex_debug;
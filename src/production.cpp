@@ -29,26 +29,34 @@ module;
 
 #include "debug.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 
 module LSys.Production;
 
+import LSys.Bytecode;
 import LSys.Expression;
+import LSys.List;
+import LSys.ModelStream;
 import LSys.Module;
+import LSys.ModuleString;
 import LSys.Name;
 import LSys.Rand;
 import LSys.SymbolTable;
 import LSys.Value;
+import LSys.ValueFrame;
 
 namespace LSYS
 {
 
 Production::Production(const Name& name,
                        std::unique_ptr<Predecessor> input,
-                       std::unique_ptr<const Expression> condition,
-                       std::unique_ptr<const List<Successor>> successors)
+                       std::unique_ptr<Expression> condition,
+                       std::unique_ptr<List<Successor>> successors)
   : m_productionName{name},
     m_input{std::move(input)},
     m_condition{std::move(condition)},
@@ -66,32 +74,136 @@ Production::Production(const Name& name,
 
   m_contextFree = (nullptr == m_input->left) and (nullptr == m_input->right);
 
+  IndexSuccessors();
+
   PDebug(PD_PRODUCTION, std::cerr << "Production::Production: created " << *this << "\n");
 }
 
-// See if module m matches the left hand side of this production and
-//  satisfies the conditional expression attached to it. The list
-//  iterator must be set at m, as it provides context for context-sensitive
-//  productions. Neither the iterator nor the module are modified.
+// A successor is chosen by a uniform random number r as the first one whose
+//  cumulative probability reaches r. So probabilities summing to more than 1
+//  leave later successors (partly) unreachable, and summing to less than 1
+//  leave no successor for large r. The running maximum of the cumulative
+//  probabilities is non-decreasing, even with negative probabilities, and
+//  reaches r at the same successor, so it can be binary searched.
+auto Production::IndexSuccessors() -> void
+{
+  m_cumulativeProbabilities.clear();
+  m_successorModules.clear();
+
+  auto cumulativeProbability = 0.0F;
+  auto runningMax            = std::numeric_limits<float>::lowest();
+  auto successorIter         = ConstListIterator<Successor>{*m_successors};
+  for (const auto* succ = successorIter.first(); succ != nullptr; succ = successorIter.next())
+  {
+    cumulativeProbability += succ->m_probability;
+    runningMax = std::max(runningMax, cumulativeProbability);
+    m_cumulativeProbabilities.push_back(runningMax);
+    m_successorModules.push_back(succ->m_moduleList.get());
+  }
+}
+
+auto Production::ChooseSuccessor(const float randomVar) const noexcept -> const List<Module>*
+{
+  const auto chosen = std::ranges::lower_bound(m_cumulativeProbabilities, randomVar);
+  if (chosen == m_cumulativeProbabilities.end())
+  {
+    return nullptr;
+  }
+  return m_successorModules[static_cast<size_t>(chosen - m_cumulativeProbabilities.begin())];
+}
+
+// The formals of the left context, predecessor and right context share one
+//  frame; a name bound twice uses the same slot, so the last binding wins
+//  as it did when formals were bound by name.
+auto Production::ResolveNames(ConstantFrame& constants, const SymbolTable<Value>& symbolTable)
+    -> size_t
+{
+  auto formalSlots = NameSlots{};
+  const auto forEachPredecessorModule = [this](const auto& func)
+  {
+    for (auto* const context : {m_input->left.get(), m_input->right.get()})
+    {
+      if (context == nullptr)
+      {
+        continue;
+      }
+      auto moduleIter = ListIterator<Module>{*context};
+      for (auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
+      {
+        func(*module);
+      }
+    }
+    func(*m_input->center);
+  };
+
+  forEachPredecessorModule([&formalSlots](const Module& module)
+                           { module.AddFormalSlots(formalSlots); });
+  forEachPredecessorModule([&](Module& module)
+                           { module.ResolveNames(formalSlots, constants, symbolTable); });
+
+  if (m_condition != nullptr)
+  {
+    m_condition->ResolveNames(formalSlots, constants, symbolTable);
+  }
+
+  auto successorIter = ListIterator<Successor>{*m_successors};
+  for (auto* succ = successorIter.first(); succ != nullptr; succ = successorIter.next())
+  {
+    auto moduleIter = ListIterator<Module>{*succ->m_moduleList};
+    for (auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
+    {
+      module->ResolveNames(formalSlots, constants, symbolTable);
+    }
+  }
+
+  return formalSlots.size();
+}
+
+auto Production::SetCompiled(const bool compiled) -> void
+{
+  m_conditionCode.reset();
+  if (compiled and (m_condition != nullptr))
+  {
+    m_conditionCode = std::make_unique<Bytecode>();
+    m_condition->Compile(*m_conditionCode);
+    m_conditionCode->EndExpression();
+  }
+
+  auto successorIter = ListIterator<Successor>{*m_successors};
+  for (auto* succ = successorIter.first(); succ != nullptr; succ = successorIter.next())
+  {
+    auto moduleIter = ListIterator<Module>{*succ->m_moduleList};
+    for (auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
+    {
+      module->SetCompiled(compiled);
+    }
+  }
+}
+
+// See if module 'pos' of the module string matches the left hand side of
+//  this production and satisfies the conditional expression attached to it.
+//  The rest of the module string provides context for context-sensitive
+//  productions. The module string is not modified.
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-auto Production::Matches(const ListIterator<Module>& modIter,
-                         const Module* const mod,
-                         SymbolTable<Value>& symbolTable) const -> bool
+auto Production::Matches(const ModuleString& modules,
+                         const size_t pos,
+                         ValueFrame& valueFrame) const -> bool
 {
   PDebug(PD_PRODUCTION,
-         std::cerr << "Production::Matches: testing module " << *mod << " against " << *this
-                   << "\n");
-  PDebug(PD_PRODUCTION, std::cerr << "\t" << *m_input->center << " matches? " << *mod << "\n");
+         std::cerr << "Production::Matches: testing module " << modules.ToString(pos)
+                   << " against " << *this << "\n");
+  PDebug(PD_PRODUCTION,
+         std::cerr << "\t" << *m_input->center << " matches? " << modules.ToString(pos) << "\n");
 
   // Test the predecessor module itself
-  if (not m_input->center->Conforms(*mod))
+  if (not m_input->center->Conforms(modules, pos))
   {
     return false;
   }
 
   // Bind formal parameters of the predecessor
   // Should test return value to ensure binding occurred
-  m_input->center->Bind(*mod, symbolTable);
+  m_input->center->Bind(modules, pos, valueFrame);
 
   // Now match context-sensitive surroundings, if any.
 
@@ -101,61 +213,63 @@ auto Production::Matches(const ListIterator<Module>& modIter,
     PDebug(PD_PRODUCTION, std::cerr << "    [left context]\n");
     // Scan each list in Reverse order
     auto listIterFormal  = ListIterator<Module>{*m_input->left};
-    auto listIterValue   = ListIterator<Module>{modIter};
+    auto listIterValue   = ModuleStringIterator{modules};
     const Module* formal = nullptr;
-    const Module* value  = nullptr;
+    auto value           = false;
+    listIterValue.SetPos(pos);
     for (formal = listIterFormal.last(), value = listIterValue.previous();
-         (formal != nullptr) and (value != nullptr);
+         (formal != nullptr) and value;
          formal = listIterFormal.previous(), value = listIterValue.previous())
     {
 
       // Find the next potentially matching module; skip over ignored modules
       // as well as bracketed substrings (e.g. A < B matches A[anything]B).
-      for (auto brackets = 0; value != nullptr; value = listIterValue.previous())
+      for (; value; value = listIterValue.previous())
       {
+        const auto valuePos = listIterValue.GetPos();
         // Skip over ignored modules
-        if (value->Ignore())
+        if (modules.Ignore(valuePos))
         {
           continue;
         }
-        // Skip over ], and increase bracket level.
-        if (IsRightBracket(value->GetName()))
+        // Skip over a bracketed substring, from its ] back to its [.
+        if (modules.IsRightBracket(valuePos))
         { // ]
-          ++brackets;
+          const auto leftBracket = modules.GetMatchingBracket(valuePos);
+          if (leftBracket == ModuleString::NO_BRACKET)
+          {
+            return false;
+          }
+          listIterValue.SetPos(leftBracket);
           continue;
         }
-        // Skip over [, and decrease bracket level iff > 0
-        if (IsLeftBracket(value->GetName()))
+        // Skip over [, moving out to the enclosing branch
+        if (modules.IsLeftBracket(valuePos))
         { // [
-          if (brackets > 0)
-          {
-            --brackets;
-          }
           continue;
         }
         // Found a potentially matching module
-        if (0 == brackets)
-        {
-          break;
-        }
+        break;
       }
 
       // If start of string was reached without finding a potentially
       // matching module, context matching failed.
-      if (nullptr == value)
+      if (not value)
       {
         return false;
       }
 
-      PDebug(PD_PRODUCTION, std::cerr << "\t" << *formal << " matches? " << *value << '\n');
+      PDebug(PD_PRODUCTION,
+             std::cerr << "\t" << *formal << " matches? "
+                       << modules.ToString(listIterValue.GetPos()) << '\n');
 
       // See if the formal and value modules conform
-      if (not formal->Conforms(*value))
+      if (not formal->Conforms(modules, listIterValue.GetPos()))
       {
         return false;
       }
       // Bind formal arguments
-      formal->Bind(*value, symbolTable);
+      formal->Bind(modules, listIterValue.GetPos(), valueFrame);
     }
 
     // If the formal parameter list is non-0, context matching failed
@@ -171,14 +285,15 @@ auto Production::Matches(const ListIterator<Module>& modIter,
   if (m_input->right != nullptr)
   {
     auto listIterFormal  = ListIterator<Module>{*m_input->right};
-    auto listIterValue   = ListIterator<Module>{modIter};
+    auto listIterValue   = ModuleStringIterator{modules};
     const Module* formal = nullptr;
-    const Module* value  = nullptr;
+    auto value           = false;
+    listIterValue.SetPos(pos);
 
     PDebug(PD_PRODUCTION, std::cerr << "    [right context]\n");
     // Scan each list in Reverse order
     for (formal = listIterFormal.first(), value = listIterValue.next();
-         (formal != nullptr) and (value != nullptr);
+         (formal != nullptr) and value;
          formal = listIterFormal.next(), value = listIterValue.next())
     {
       // Find the next potentially matching module; skip over
@@ -187,7 +302,7 @@ auto Production::Matches(const ListIterator<Module>& modIter,
       if (IsLeftBracket(formal->GetName()))
       { // [
         // Must find a matching [; skip only ignored modules
-        while ((value != nullptr) and value->Ignore())
+        while (value and modules.Ignore(listIterValue.GetPos()))
         {
           value = listIterValue.next();
         }
@@ -196,20 +311,14 @@ auto Production::Matches(const ListIterator<Module>& modIter,
       { // ]
         // Must find a matching ]; skip anything else including
         //  bracketed substrings.
-        for (auto brackets = 0; value != nullptr; value = listIterValue.next())
+        if (value and (not modules.IsRightBracket(listIterValue.GetPos())))
         {
-          if (IsRightBracket(value->GetName()))
-          { // ]
-            if (0 == brackets)
-            {
-              break;
-            }
-            --brackets;
-          }
-          else if (IsLeftBracket(value->GetName()))
-          { // [
-            ++brackets;
+          const auto branchEnd = modules.GetBranchEnd(listIterValue.GetPos());
+          if (branchEnd == ModuleString::NO_BRACKET)
+          {
+            return false;
           }
+          listIterValue.SetPos(branchEnd);
         }
       }
       else
@@ -217,57 +326,55 @@ auto Production::Matches(const ListIterator<Module>& modIter,
         // Find the next potentially matching module; skip over
         //  ignored modules as well as bracketed substrings,
         //  (e.g. A > B matches A[anything]B)
-        for (auto brackets = 0; value != nullptr; value = listIterValue.next())
+        for (; value; value = listIterValue.next())
         {
+          const auto valuePos = listIterValue.GetPos();
           // Skip over ignored modules
-          if (value->Ignore())
+          if (modules.Ignore(valuePos))
           {
             continue;
           }
-          if (IsLeftBracket(value->GetName()))
+          // Skip over a bracketed substring, from its [ to its ].
+          if (modules.IsLeftBracket(valuePos))
           { // [
-            ++brackets;
-            continue;
-          }
-          if (IsRightBracket(value->GetName()))
-          { // ]
-            if (brackets > 0)
+            const auto rightBracket = modules.GetMatchingBracket(valuePos);
+            if (rightBracket == ModuleString::NO_BRACKET)
             {
-              --brackets;
-            }
-            else
-            {
-              // This is a case like B > C against A[B]C; it
-              //	should not match, because C is not along
-              //	the same path from root to branch as B.
               return false;
             }
+            listIterValue.SetPos(rightBracket);
             continue;
           }
-          // Found a potentially matching module
-          if (0 == brackets)
-          {
-            break;
+          if (modules.IsRightBracket(valuePos))
+          { // ]
+            // This is a case like B > C against A[B]C; it
+            //	should not match, because C is not along
+            //	the same path from root to branch as B.
+            return false;
           }
+          // Found a potentially matching module
+          break;
         }
       }
 
       // If start of string was reached without finding a potentially
       //	matching module, context matching failed.
-      if (nullptr == value)
+      if (not value)
       {
         return false;
       }
 
-      PDebug(PD_PRODUCTION, std::cerr << "\t" << *formal << " Matches? " << *value << '\n');
+      PDebug(PD_PRODUCTION,
+             std::cerr << "\t" << *formal << " Matches? "
+                       << modules.ToString(listIterValue.GetPos()) << '\n');
 
       // See if the formal and value modules conform
-      if (not formal->Conforms(*value))
+      if (not formal->Conforms(modules, listIterValue.GetPos()))
       {
         return false;
       }
       // Bind formal arguments
-      formal->Bind(*value, symbolTable);
+      formal->Bind(modules, listIterValue.GetPos(), valueFrame);
     }
 
     // If the formal parameter list is non-0, context matching failed
@@ -287,7 +394,8 @@ auto Production::Matches(const ListIterator<Module>& modIter,
     return true;
   }
 
-  const auto value = m_condition->Evaluate(symbolTable);
+  const auto value = (m_conditionCode != nullptr) ? m_conditionCode->Run(valueFrame)[0]
+                                                  : m_condition->Evaluate(valueFrame);
   PDebug(PD_PRODUCTION, std::cerr << "    [condition] -> " << value << "\n");
   if (auto i = 0; value.GetIntValue(i))
   {
@@ -296,38 +404,63 @@ auto Production::Matches(const ListIterator<Module>& modIter,
   return false;
 }
 
-// Given a module which matches() the left hand side of this
-//  production, apply the production and return the resulting
-//  module list.
-auto Production::Produce(const Module* const predecessor, SymbolTable<Value>& symbolTable) const
-    -> std::unique_ptr<List<Module>>
+auto Production::IsDeterministic() const -> bool
 {
-  auto moduleList = std::make_unique<List<Module>>();
+  if ((not m_contextFree) or (m_condition != nullptr) or (m_successors->size() != 1))
+  {
+    return false;
+  }
 
-  // If no successors for this production, die (could return an empty list
-  //	or return a copy of the predecessor).
-  if (0 == m_successors->size())
+  auto successorIter = ConstListIterator<Successor>{*m_successors};
+  return successorIter.first()->m_probability >= 1.0F;
+}
+
+auto Production::GetDeterministicSuccessor() const -> const List<Module>&
+{
+  if (not IsDeterministic())
   {
-    throw std::runtime_error("Production::Produce: Error: production has no successors");
+    throw std::runtime_error(
+        "Production::GetDeterministicSuccessor: production is not deterministic");
   }
 
-  // Pick one of the successors of the production at random.
-  const auto randomVar       = static_cast<float>(GetRandDoubleInUnitInterval());
-  auto cumulativeProbability = 0.0F;
+  auto successorIter = ConstListIterator<Successor>{*m_successors};
+  return *successorIter.first()->m_moduleList;
+}
 
-  const List<Module>* modList = nullptr;
-  const Successor* succ       = nullptr;
-  auto successorIter          = ConstListIterator<Successor>{*m_successors};
-  for (modList = nullptr, succ = successorIter.first(); succ != nullptr;
-       succ = successorIter.next())
+auto Production::HasSuccessorModule(const Name& name) const -> bool
+{
+  for (const auto* const moduleList : m_successorModules)
   {
-    cumulativeProbability += succ->m_probability;
-    if (randomVar <= cumulativeProbability)
+    auto moduleIter = ConstListIterator<Module>{*moduleList};
+    for (const auto* module = moduleIter.first(); module != nullptr; module = moduleIter.next())
     {
-      modList = succ->m_moduleList.get();
-      break;
+      if (module->GetName() == name)
+      {
+        return true;
+      }
     }
   }
+  return false;
+}
+
+// Given module 'pos' of the module string which matches() the left
+//  hand side of this production, apply the production and append the
+//  resulting modules to the successor string.
+auto Production::Produce([[maybe_unused]] const ModuleString& modules,
+                         [[maybe_unused]] const size_t pos,
+                         ValueFrame& valueFrame,
+                         ModuleString& successor) const -> void
+{
+  // If no successors for this production, die (could return an empty list
+  //	or return a copy of the predecessor).
+  if (0 == m_successors->size())
+  {
+    throw std::runtime_error("Production::Produce: Error: production has no successors");
+  }
+
+  // Pick one of the successors of the production at random.
+  const auto randomVar      = static_cast<float>(GetRandDoubleInUnitInterval());
+  const auto* const modList = ChooseSuccessor(randomVar);
 
   // If no successor was chosen, complain and return an empty list
   if (nullptr == modList)
@@ -337,21 +470,76 @@ auto Production::Produce(const Module* const predecessor, SymbolTable<Value>& sy
     //    return moduleList;
   }
 
-  // For each module in the successor side, instantiate it and add to the list.
-  auto modIter = ConstListIterator<Module>{*modList};
-  for (const auto* mod = modIter.first(); mod != nullptr; mod = modIter.next())
-  {
-    auto newModule = mod->Instantiate(symbolTable);
-    moduleList->append(std::move(newModule));
-  }
+  // For each module in the successor side, instantiate it and add to the string.
+  [[maybe_unused]] const auto successorStart = successor.size();
+  Instantiate(*modList, valueFrame, successor);
 
   PDebug(PD_PRODUCTION,
          std::cerr << "Production::Produce:\n"
                    << "Production is:  " << *this << "\n"
-                   << "Predecessor is: " << *predecessor << "\n"
-                   << "Result is:      " << *moduleList << "\n");
+                   << "Predecessor is: " << modules.ToString(pos) << "\n"
+                   << "Result is:      ";
+         for (auto i = successorStart; i < successor.size(); ++i) {
+           successor.Print(std::cerr, i);
+         }
+         std::cerr << "\n");
+}
+
+auto Predecessor::Write(ModelWriter& writer) const -> void
+{
+  WriteList(writer, left.get());
+  writer.WriteBool(center != nullptr);
+  if (center != nullptr)
+  {
+    center->Write(writer);
+  }
+  WriteList(writer, right.get());
+}
+
+auto Predecessor::Read(ModelReader& reader) -> std::unique_ptr<Predecessor>
+{
+  auto lft = ReadList<Module>(reader);
+  auto cen = reader.ReadBool() ? Module::Read(reader) : nullptr;
+  auto rgt = ReadList<Module>(reader);
+  return std::make_unique<Predecessor>(std::move(lft), std::move(cen), std::move(rgt));
+}
+
+auto Successor::Write(ModelWriter& writer) const -> void
+{
+  writer.WriteFloat(m_probability);
+  WriteList(writer, m_moduleList.get());
+}
 
-  return moduleList;
+auto Successor::Read(ModelReader& reader) -> std::unique_ptr<Successor>
+{
+  const auto probability = reader.ReadFloat();
+  return std::make_unique<Successor>(ReadList<Module>(reader), probability);
+}
+
+auto Production::Write(ModelWriter& writer) const -> void
+{
+  writer.WriteName(m_productionName);
+  m_input->Write(writer);
+  writer.WriteBool(m_condition != nullptr);
+  if (m_condition != nullptr)
+  {
+    m_condition->Write(writer);
+  }
+  WriteList(writer, m_successors.get());
+}
+
+auto Production::Read(ModelReader& reader) -> std::unique_ptr<Production>
+{
+  const auto name = reader.ReadName();
+  auto input      = Predecessor::Read(reader);
+  auto condition  = reader.ReadBool() ? Expression::Read(reader) : nullptr;
+  auto successors = ReadList<Successor>(reader);
+  if ((input->center == nullptr) or (successors == nullptr))
+  {
+    throw std::runtime_error("Production::Read: production without a predecessor or successors.");
+  }
+  return std::make_unique<Production>(
+      name, std::move(input), std::move(condition), std::move(successors));
 }
 
 auto operator<<(std::ostream& out, const Successor& successor) -> std::ostream&
@@ -7,7 +7,7 @@ module;
 
 module LSys.RadianceGenerator;
 
-import LSys.Module;
+import LSys.Name;
 import LSys.Vector;
 
 namespace LSYS
@@ -195,10 +195,10 @@ auto RadianceGenerator::LineTo() -> void
   IGenerator::LineTo();
 }
 
-auto RadianceGenerator::DrawObject(const Module& mod, const int numArgs, const ArgsArray& args)
+auto RadianceGenerator::DrawObject(const Name& name, const int numArgs, const ArgsArray& args)
     -> void
 {
-  const auto objName      = mod.GetName().str().erase(0, 1); // skip '~'
+  const auto objName      = name.str().substr(1); // skip '~'
   const auto contactPoint = GetLastPosition();
 
   ++m_groupNum;
@@ -1,6 +1,9 @@
 module;
 
-#include <cassert>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 
 module LSys.Rand;
 
@@ -9,19 +12,101 @@ namespace LSYS
 
 namespace
 {
+
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-GetRandDoubleInUnitIntervalFunc getRandDouble{};
+thread_local RandomEngine* threadRandomEngine = nullptr;
+
+[[nodiscard]] auto GetDefaultRandomEngine() noexcept -> RandomEngine&
+{
+  thread_local auto defaultRandomEngine = RandomEngine{};
+  return defaultRandomEngine;
+}
+
+[[nodiscard]] constexpr auto SplitMix64(uint64_t& state) noexcept -> uint64_t
+{
+  state += 0x9E3779B97F4A7C15ULL;
+  auto mixed = state;
+  mixed      = (mixed ^ (mixed >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  mixed      = (mixed ^ (mixed >> 27U)) * 0x94D049BB133111EBULL;
+  return mixed ^ (mixed >> 31U);
+}
+
+// One xoshiro256** step: returns the next number and advances the state.
+[[nodiscard]] constexpr auto Next(std::array<uint64_t, 4>& state) noexcept -> uint64_t
+{
+  auto& [s0, s1, s2, s3] = state;
+  const auto number      = std::rotl(s1 * 5U, 7) * 9U;
+  const auto tmp         = s1 << 17U;
+  s2 ^= s0;
+  s3 ^= s1;
+  s1 ^= s2;
+  s0 ^= s3;
+  s2 ^= tmp;
+  s3 = std::rotl(s3, 45);
+  return number;
+}
+
+} // namespace
+
+RandomEngine::RandomEngine(const uint64_t seed) noexcept
+{
+  auto splitMixState = seed;
+  for (auto& word : m_state)
+  {
+    word = SplitMix64(splitMixState);
+  }
+}
+
+auto RandomEngine::FillBatch() noexcept -> void
+{
+  // Work on a local copy so the state stays in registers across the batch.
+  auto state = m_state;
+  for (auto& number : m_batch)
+  {
+    number = Next(state);
+  }
+  m_state       = state;
+  m_nextInBatch = 0;
+}
+
+auto RandomEngine::Jump() noexcept -> void
+{
+  static constexpr auto JUMP = std::array<uint64_t, 4>{
+      0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+
+  auto jumped = std::array<uint64_t, 4>{};
+  for (const auto jumpWord : JUMP)
+  {
+    for (auto bit = 0U; bit < 64U; ++bit)
+    {
+      if ((jumpWord & (uint64_t{1} << bit)) != 0)
+      {
+        for (auto i = 0U; i < jumped.size(); ++i)
+        {
+          jumped[i] ^= m_state[i];
+        }
+      }
+      static_cast<void>(Next(m_state));
+    }
+  }
+  m_state       = jumped;
+  m_nextInBatch = BATCH_SIZE;
 }
 
-auto SetRandFunc(const GetRandDoubleInUnitIntervalFunc& getRandDoubleFunc) -> void
+auto SetThreadRandomEngine(RandomEngine* const engine) noexcept -> RandomEngine*
 {
-  getRandDouble = getRandDoubleFunc;
+  auto* const previousEngine = threadRandomEngine;
+  threadRandomEngine         = engine;
+  return previousEngine;
 }
 
-auto GetRandDoubleInUnitInterval() -> double
+auto GetRandDoubleInUnitInterval() noexcept -> double
 {
-  assert(getRandDouble);
-  return getRandDouble();
+  if (threadRandomEngine != nullptr)
+  {
+    return threadRandomEngine->GetDouble();
+  }
+  return GetDefaultRandomEngine().GetDouble();
 }
 
 } // namespace LSYS
@@ -35,13 +35,16 @@ module;
 
 #include "debug.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
-#include <stdexcept>
 
 module LSys.Turtle;
 
 import LSys.Consts;
+import LSys.Simd;
+import LSys.Vector;
 
 namespace LSYS
 {
@@ -61,6 +64,8 @@ Turtle::Turtle(const float widthScale, const float turnAngleInDegrees)
 
 auto Turtle::ResetDrawingParamsToDefaults() -> void
 {
+  SaveAttributes();
+
   m_currentState = State{};
 
   SetDefaultDistance(1.0F);
@@ -131,11 +136,13 @@ auto Turtle::SetGravity(const Vector& gravity) -> void
 
 auto Turtle::SetTropismVector(const Vector& vector) -> void
 {
+  SaveAttributes();
   m_currentState.tropism.tropismVector = vector;
 }
 
 auto Turtle::SetTropismSusceptibility(const float susceptibility) -> void
 {
+  SaveAttributes();
   assert(0.0F <= susceptibility);
   assert(1.0F >= susceptibility);
   m_currentState.tropism.susceptibility = susceptibility;
@@ -143,11 +150,13 @@ auto Turtle::SetTropismSusceptibility(const float susceptibility) -> void
 
 auto Turtle::DisableTropism() -> void
 {
+  SaveAttributes();
   m_currentState.tropism.flag = false;
 }
 
 auto Turtle::EnableTropism() -> void
 {
+  SaveAttributes();
   m_currentState.tropism.flag = true;
 }
 
@@ -159,35 +168,62 @@ auto Turtle::SetWidth(const float width) -> void
 
 auto Turtle::SetDefaultDistance(const float distance) -> void
 {
+  SaveAttributes();
   m_currentState.defaultDistance = distance;
 }
 
 auto Turtle::SetDefaultTurnAngleInDegrees(const float turnAngleInDegrees) -> void
 {
+  SaveAttributes();
   m_currentState.defaultTurnAngleInRadians = MATHS::ToRadians(turnAngleInDegrees);
+  UpdateDefaultRotations();
+}
+
+auto Turtle::UpdateDefaultRotations() -> void
+{
+  const auto angle = m_currentState.defaultTurnAngleInRadians;
+  for (const auto axis : {Matrix::Axis::X, Matrix::Axis::Y, Matrix::Axis::Z})
+  {
+    const auto index               = 2U * static_cast<uint32_t>(axis);
+    m_defaultRotations[index]      = Matrix::GetRotation(axis, angle);
+    m_defaultRotations[index + 1U] = Matrix::GetRotation(axis, -angle);
+  }
+  m_defaultRotationsAngleInRadians = angle;
+}
+
+auto Turtle::GetDefaultRotation(const Matrix::Axis axis, const Direction direction) const
+    -> const Matrix&
+{
+  const auto index = (2U * static_cast<uint32_t>(axis)) +
+                     ((direction == Direction::POSITIVE) ? 0U : 1U);
+  return m_defaultRotations[index];
 }
 
 // Set color index. This is interpreted by the output generator.
 // It may index a color map or define a grayscale value.
 auto Turtle::SetColor(const int color) -> void
 {
+  SaveAttributes();
   m_currentState.color = Color(color);
 }
 
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
 auto Turtle::SetColor(const int color, const int backgroundColor) -> void
 {
+  SaveAttributes();
   m_currentState.color           = Color(color);
   m_currentState.backgroundColor = Color(backgroundColor);
 }
 
 auto Turtle::SetColor(const Vector& colorVector) -> void
 {
+  SaveAttributes();
   m_currentState.color = Color{colorVector};
 }
 
 auto Turtle::IncrementColor() -> void
 {
+  SaveAttributes();
   if (m_currentState.color.colorType == ColorType::INDEX)
   {
     ++m_currentState.color.m_color.index;
@@ -201,19 +237,13 @@ auto Turtle::IncrementColor() -> void
 // Set texture index. This is interpreted by the output generator.
 auto Turtle::SetTexture(const int texture) -> void
 {
+  SaveAttributes();
   m_currentState.texture = texture;
 }
 
 auto Turtle::Turn(const Direction direction) -> void
 {
-  if (direction == Direction::POSITIVE)
-  {
-    m_currentState.frame.Rotate(Matrix::Axis::Z, m_currentState.defaultTurnAngleInRadians);
-  }
-  else
-  {
-    m_currentState.frame.Rotate(Matrix::Axis::Z, -m_currentState.defaultTurnAngleInRadians);
-  }
+  m_currentState.frame = m_currentState.frame * GetDefaultRotation(Matrix::Axis::Z, direction);
 }
 
 auto Turtle::Turn(const float angle) -> void
@@ -223,14 +253,7 @@ auto Turtle::Turn(const float angle) -> void
 
 auto Turtle::Pitch(const Direction direction) -> void
 {
-  if (direction == Direction::POSITIVE)
-  {
-    m_currentState.frame.Rotate(Matrix::Axis::Y, m_currentState.defaultTurnAngleInRadians);
-  }
-  else
-  {
-    m_currentState.frame.Rotate(Matrix::Axis::Y, -m_currentState.defaultTurnAngleInRadians);
-  }
+  m_currentState.frame = m_currentState.frame * GetDefaultRotation(Matrix::Axis::Y, direction);
 }
 
 auto Turtle::Pitch(const float angle) -> void
@@ -240,14 +263,7 @@ auto Turtle::Pitch(const float angle) -> void
 
 auto Turtle::Roll(const Direction direction) -> void
 {
-  if (direction == Direction::POSITIVE)
-  {
-    m_currentState.frame.Rotate(Matrix::Axis::X, m_currentState.defaultTurnAngleInRadians);
-  }
-  else
-  {
-    m_currentState.frame.Rotate(Matrix::Axis::X, -m_currentState.defaultTurnAngleInRadians);
-  }
+  m_currentState.frame = m_currentState.frame * GetDefaultRotation(Matrix::Axis::X, direction);
 }
 
 auto Turtle::Roll(const float angle) -> void
@@ -290,6 +306,80 @@ auto Turtle::RollHorizontal() -> void
   SetUp(up);
 }
 
+// The planar turns and moves need a frame with up (0, 0, 1), heading and
+// left with zero z components and no translation. The zeros the 3D math adds
+// to the x and y components must be +0, for the planar results to match it
+// down to the sign of zero. Popped poses must be planar too, and tropism,
+// which bends the heading out of the plane, off.
+auto Turtle::IsPlanar() const -> bool
+{
+  const auto isFramePlanar = [](const Matrix& frame)
+  {
+    const auto isPositiveZero = [](const float val)
+    { return (val == 0.0F) and (not std::signbit(val)); };
+
+    return isPositiveZero(frame[0][2]) and isPositiveZero(frame[1][2]) and
+           (frame[2][2] == 1.0F) and (frame[2][0] == 0.0F) and (frame[2][1] == 0.0F) and
+           isPositiveZero(frame[0][3]) and isPositiveZero(frame[1][3]) and
+           isPositiveZero(frame[2][3]);
+  };
+
+  return (not m_currentState.tropism.flag) and isFramePlanar(m_currentState.frame) and
+         std::ranges::all_of(m_poseStack,
+                             [&isFramePlanar](const Pose& pose)
+                             { return isFramePlanar(pose.frame); });
+}
+
+auto Turtle::TurnInPlane(const Direction direction) -> void
+{
+  RotateInPlane(GetDefaultRotation(Matrix::Axis::Z, direction));
+}
+
+auto Turtle::TurnInPlane(const float angle) -> void
+{
+  RotateInPlane(Matrix::GetRotation(Matrix::Axis::Z, angle));
+}
+
+// Post-multiply a planar frame by a rotation around the z axis. Only the
+// heading and left x and y rows of the product change, and in those the
+// product with up adds +0 to every lane: +0 is still added, as it turns a -0
+// sum into +0. Up and the translation stay +0 in those rows, and the z row
+// is always (0, 0, 1, 0) afterwards.
+auto Turtle::RotateInPlane(const Matrix& rotation) -> void
+{
+  const auto rotationX = Float4::Load(rotation[0]);
+  const auto rotationY = Float4::Load(rotation[1]);
+  const auto zero      = Float4::Broadcast(0.0F);
+
+  auto& frame = m_currentState.frame;
+  for (auto i = 0U; i < 2U; ++i)
+  {
+    auto row = Float4::Broadcast(frame[i][0]) * rotationX;
+    row      = row + (Float4::Broadcast(frame[i][1]) * rotationY);
+    row      = row + zero;
+    row.Store(frame[i]);
+  }
+  Float4{0.0F, 0.0F, 1.0F, 0.0F}.Store(frame[2]);
+}
+
+auto Turtle::MoveInPlane() -> void
+{
+  MoveInPlane(m_currentState.defaultDistance);
+}
+
+// The heading's z component is +-0, so z stays +0 as it does in Move. With
+// tropism off there is no correction to apply.
+auto Turtle::MoveInPlane(const float distance) -> void
+{
+  const auto& frame    = m_currentState.frame;
+  const auto heading   = Float4{frame[0][0], frame[1][0], 0.0F, 0.0F};
+  const auto distance4 = Float4::Broadcast(distance);
+  const auto position  = m_currentState.position.GetLanes() + (distance4 * heading);
+
+  m_currentState.position = Vector{position};
+  m_boundingBox.Expand(position);
+}
+
 auto Turtle::Move() -> void
 {
   Move(m_currentState.defaultDistance);
@@ -300,8 +390,14 @@ auto Turtle::Move() -> void
 // if that is enabled.
 auto Turtle::Move(const float distance) -> void
 {
-  m_currentState.position += distance * GetHeading();
-  m_boundingBox.Expand(m_currentState.position);
+  // The heading is the first column of the frame.
+  const auto& frame    = m_currentState.frame;
+  const auto heading   = Float4{frame[0][0], frame[1][0], frame[2][0], 0.0F};
+  const auto distance4 = Float4::Broadcast(distance);
+  const auto position  = m_currentState.position.GetLanes() + (distance4 * heading);
+
+  m_currentState.position = Vector{position};
+  m_boundingBox.Expand(position);
 
   // TODO(glk) - this seems wrong.
   //   Compare 'Examples/ternary_tree_a' to ABP figure 2.8a
@@ -317,20 +413,34 @@ auto Turtle::Move(const float distance) -> void
   }
 }
 
-auto Turtle::Push() -> void
+auto Turtle::ReserveStack(const size_t depth) -> void
 {
-  m_stateStack.emplace(m_currentState);
+  m_poseStack.reserve(depth);
+  m_attributesStack.reserve(depth);
 }
 
-auto Turtle::Pop() -> void
+auto Turtle::SetPose(const Pose& pose, const std::vector<Pose>& poseStack) -> void
 {
-  if (m_stateStack.empty())
-  {
-    throw std::runtime_error("Turtle::Pop: turtle stack is empty.");
-  }
+  static_cast<Pose&>(m_currentState) = pose;
+  m_poseStack = poseStack;
+  // The attributes are kept as they are, so there are none to restore.
+  m_attributesStack.clear();
+}
 
-  m_currentState = m_stateStack.top();
-  m_stateStack.pop();
+auto Turtle::ExpandBoundingBox(const BoundingBox& boundingBox) -> void
+{
+  m_boundingBox.Expand(boundingBox.Min());
+  m_boundingBox.Expand(boundingBox.Max());
+}
+
+// The relative frame is applied in the pose's frame, and the relative
+// position taken along the pose's axes. The width is not relative: a
+// relative pose starts with the width it is composed with.
+auto Turtle::ComposePoses(const Pose& pose, const Pose& relativePose) -> Pose
+{
+  return {.frame    = pose.frame * relativePose.frame,
+          .position = pose.position + (pose.frame * relativePose.position),
+          .width    = relativePose.width};
 }
 
 std::ostream& operator<<(std::ostream& out, const Turtle& turtle)
@@ -44,6 +44,8 @@ module;
 
 module LSys.Vector;
 
+import LSys.Simd;
+
 namespace LSYS
 {
 // NOLINTBEGIN(cppcoreguidelines-pro-bounds-constant-array-index,
@@ -54,22 +56,6 @@ static constexpr uint32_t Y = 1U;
 static constexpr uint32_t Z = 2U;
 static constexpr uint32_t W = 3U;
 
-// Expand the box to include the specified point
-auto BoundingBox::Expand(const Vector& point) -> void
-{
-  for (auto i = X; i <= Z; ++i)
-  {
-    if (point(i) > m_maxVec[i])
-    {
-      m_maxVec[i] = point(i);
-    }
-    else if (point(i) < m_minVec[i])
-    {
-      m_minVec[i] = point(i);
-    }
-  }
-}
-
 std::ostream& operator<<(std::ostream& out, const BoundingBox& boundingBox)
 {
   return out << "[ min: " << boundingBox.Min() << " max: " << boundingBox.Max() << " ]";
@@ -163,10 +149,10 @@ auto CosSin(float& cosVal, float& sinVal, const float angle) -> void
 }
 } // namespace
 
-// Post-multiply by axis rotation around specified Axis (x,y,z) of 'angle' radians
+// Rotation around specified Axis (x,y,z) of 'angle' radians
 // Note: this is in axis right-handed coordinate system, and transformations
 //  are performed by multiplying [matrix][pt].
-auto Matrix::Rotate(const Axis axis, const float angle) -> Matrix&
+auto Matrix::GetRotation(const Axis axis, const float angle) -> Matrix
 {
   auto cosAngle = 0.0F;
   auto sinAngle = 0.0F;
@@ -220,7 +206,13 @@ auto Matrix::Rotate(const Axis axis, const float angle) -> Matrix&
       break;
   }
 
-  *this = *this * rotatedMatrix;
+  return rotatedMatrix;
+}
+
+// Post-multiply by axis rotation around specified Axis (x,y,z) of 'angle' radians
+auto Matrix::Rotate(const Axis axis, const float angle) -> Matrix&
+{
+  *this = *this * GetRotation(axis, angle);
 
   return *this;
 }
@@ -298,20 +290,25 @@ auto Matrix::operator*(const Vector& vec) const -> Vector
       m_matrix[Z][X] * vec(X) + m_matrix[Z][Y] * vec(Y) + m_matrix[Z][Z] * vec(Z) + m_matrix[Z][W]);
 }
 
+// Each row of the product is a sum of the other matrix's rows, scaled by
+// this row's entries, and so is worked out four lanes at a time. This row's
+// translation is added in the W lane only: adding -0 leaves the other lanes
+// exactly as they were, so the result matches the scalar sums.
 auto Matrix::operator*(const Matrix& otherMatrix) const -> Matrix
 {
+  const auto otherRowX = Float4::Load(otherMatrix[X]);
+  const auto otherRowY = Float4::Load(otherMatrix[Y]);
+  const auto otherRowZ = Float4::Load(otherMatrix[Z]);
+
   auto res = Matrix{};
 
   for (auto i = X; i <= Z; ++i)
   {
-    res[i][X] = m_matrix[i][X] * otherMatrix[X][X] + m_matrix[i][Y] * otherMatrix[Y][X] +
-                m_matrix[i][Z] * otherMatrix[Z][X];
-    res[i][Y] = m_matrix[i][X] * otherMatrix[X][Y] + m_matrix[i][Y] * otherMatrix[Y][Y] +
-                m_matrix[i][Z] * otherMatrix[Z][Y];
-    res[i][Z] = m_matrix[i][X] * otherMatrix[X][Z] + m_matrix[i][Y] * otherMatrix[Y][Z] +
-                m_matrix[i][Z] * otherMatrix[Z][Z];
-    res[i][W] = m_matrix[i][X] * otherMatrix[X][W] + m_matrix[i][Y] * otherMatrix[Y][W] +
-                m_matrix[i][Z] * otherMatrix[Z][W] + m_matrix[i][W];
+    auto row = Float4::Broadcast(m_matrix[i][X]) * otherRowX;
+    row      = row + (Float4::Broadcast(m_matrix[i][Y]) * otherRowY);
+    row      = row + (Float4::Broadcast(m_matrix[i][Z]) * otherRowZ);
+    row      = row + Float4{-0.0F, -0.0F, -0.0F, m_matrix[i][W]};
+    row.Store(res[i]);
   }
 
   return res;